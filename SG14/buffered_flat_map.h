@@ -0,0 +1,442 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+// buffered_flat_map is a sibling of flat_map for tables that take a steady
+// stream of inserts at random positions. A flat_map pays O(N) element
+// moves for each such insert. buffered_flat_map instead inserts into a
+// small sorted delta map, and merges the delta into the main map in one
+// linear pass once it holds more than about sqrt(N) entries, so an insert
+// costs amortized O(sqrt(N)) moves. Lookups search both maps, the small
+// delta first. Iteration merges the two in key order.
+//
+// Any insertion may merge the delta, which invalidates all iterators; so
+// does moving or swapping the map, since iterators refer to the map itself.
+// Erasure removes the element from whichever map holds it.
+
+#include "flat_map.h"
+
+#include <stddef.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stdext {
+
+namespace buffered_flatmap_detail {
+
+    // Walks the main map and the delta map together, by index, yielding
+    // whichever current key is smaller; the two never share a key.
+    template<class Map, class Compare>
+    class iter {
+        template<class, class> friend class iter;
+    public:
+        using difference_type = ptrdiff_t;
+        using value_type = typename Map::value_type;
+        using reference = typename std::conditional<std::is_const<Map>::value, typename Map::const_reference, typename Map::reference>::type;
+        using pointer = flatmap_detail::arrow_proxy<reference>;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        iter() = default;
+        explicit iter(Map *main, Map *delta, const Compare *compare, size_t mi, size_t di)
+            : main_(main), delta_(delta), compare_(compare), mi_(mi), di_(di) {}
+
+        // This is the iterator-to-const_iterator implicit conversion.
+        template<class M, class = typename std::enable_if<std::is_convertible<M*, Map*>::value>::type>
+        iter(const iter<M, Compare>& other)
+            : main_(other.main_), delta_(other.delta_), compare_(other.compare_), mi_(other.mi_), di_(other.di_) {}
+
+        reference operator*() const {
+            return from_delta() ? reference(*(delta_->begin() + di_)) : reference(*(main_->begin() + mi_));
+        }
+
+        pointer operator->() const {
+            return pointer{**this};
+        }
+
+        iter& operator++() {
+            if (from_delta()) {
+                ++di_;
+            } else {
+                ++mi_;
+            }
+            return *this;
+        }
+
+        iter& operator--() {
+            if (mi_ == 0) {
+                --di_;
+            } else if (di_ == 0) {
+                --mi_;
+            } else if ((*compare_)(main_->keys()[mi_ - 1], delta_->keys()[di_ - 1])) {
+                --di_;
+            } else {
+                --mi_;
+            }
+            return *this;
+        }
+
+        iter operator++(int) { iter result(*this); ++*this; return result; }
+        iter operator--(int) { iter result(*this); --*this; return result; }
+        friend bool operator==(const iter& a, const iter& b) { return a.mi_ == b.mi_ && a.di_ == b.di_; }
+        friend bool operator!=(const iter& a, const iter& b) { return !(a == b); }
+
+        // Whether the element is in the delta map, and its index there or
+        // in the main map.
+        bool private_impl_in_delta() const { return from_delta(); }
+        size_t private_impl_getmain() const { return mi_; }
+        size_t private_impl_getdelta() const { return di_; }
+
+    private:
+        bool from_delta() const {
+            if (di_ == delta_->size()) {
+                return false;
+            }
+            return mi_ == main_->size() || bool((*compare_)(delta_->keys()[di_], main_->keys()[mi_]));
+        }
+
+        Map *main_ = nullptr;
+        Map *delta_ = nullptr;
+        const Compare *compare_ = nullptr;
+        size_t mi_ = 0;
+        size_t di_ = 0;
+    };
+
+} // namespace buffered_flatmap_detail
+
+template<
+    class Key,
+    class Mapped,
+    class Compare = std::less<Key>,
+    class KeyContainer = std::vector<Key>,
+    class MappedContainer = std::vector<Mapped>
+>
+class buffered_flat_map {
+    using base_map = flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>;
+public:
+    using key_type = Key;
+    using mapped_type = Mapped;
+    using value_type = std::pair<const Key, Mapped>;
+    using key_compare = Compare;
+    using mapped_reference = typename base_map::mapped_reference;
+    using const_mapped_reference = typename base_map::const_mapped_reference;
+    using reference = typename base_map::reference;
+    using const_reference = typename base_map::const_reference;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using iterator = buffered_flatmap_detail::iter<base_map, Compare>;
+    using const_iterator = buffered_flatmap_detail::iter<const base_map, Compare>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using key_container_type = KeyContainer;
+    using mapped_container_type = MappedContainer;
+
+    buffered_flat_map() : buffered_flat_map(Compare()) {}
+
+    explicit buffered_flat_map(const Compare& comp) : main_(comp), delta_(comp), compare_(comp) {}
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    buffered_flat_map(InputIterator first, InputIterator last, const Compare& comp = Compare())
+        : main_(first, last, comp), delta_(comp), compare_(comp) {}
+
+    buffered_flat_map(std::initializer_list<value_type> il, const Compare& comp = Compare())
+        : buffered_flat_map(il.begin(), il.end(), comp) {}
+
+    buffered_flat_map& operator=(std::initializer_list<value_type> il) {
+        this->clear();
+        this->insert(il);
+        return *this;
+    }
+
+    iterator begin() noexcept { return make_iterator(0, 0); }
+    const_iterator begin() const noexcept { return make_iterator(0, 0); }
+    iterator end() noexcept { return make_iterator(main_.size(), delta_.size()); }
+    const_iterator end() const noexcept { return make_iterator(main_.size(), delta_.size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+#if __cplusplus >= 201703L
+    [[nodiscard]]
+#endif
+    bool empty() const noexcept { return main_.empty() && delta_.empty(); }
+    size_type size() const noexcept { return main_.size() + delta_.size(); }
+
+    // The number of entries waiting in the delta map, and the number at
+    // which the next insertion merges them into the main map.
+    size_type buffered_size() const noexcept { return delta_.size(); }
+    size_type merge_threshold() const noexcept {
+        return std::max<size_type>(32, static_cast<size_type>(std::sqrt(static_cast<double>(main_.size()))));
+    }
+
+    // Merges the delta map into the main map now.
+    void flush() {
+        if (delta_.empty()) {
+            return;
+        }
+        auto c = std::move(delta_).extract();
+        std::vector<std::pair<Key, Mapped>> batch;
+        batch.reserve(c.keys.size());
+        auto vit = c.values.begin();
+        for (auto kit = c.keys.begin(); kit != c.keys.end(); ++kit, ++vit) {
+            batch.emplace_back(std::move(*kit), std::move(*vit));
+        }
+        // Keep the delta's storage for the next round.
+        c.keys.clear();
+        c.values.clear();
+        delta_.replace(std::move(c.keys), std::move(c.values));
+        main_.insert(stdext::sorted_unique, std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    }
+
+    mapped_reference operator[](const Key& x) {
+        return try_emplace(x).first->second;
+    }
+
+    mapped_reference operator[](Key&& x) {
+        return try_emplace(static_cast<Key&&>(x)).first->second;
+    }
+
+    mapped_reference at(const Key& k) {
+        auto it = this->find(k);
+        if (it == end()) {
+            throw std::out_of_range("buffered_flat_map::at");
+        }
+        return it->second;
+    }
+
+    const_mapped_reference at(const Key& k) const {
+        auto it = this->find(k);
+        if (it == end()) {
+            throw std::out_of_range("buffered_flat_map::at");
+        }
+        return it->second;
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(const Key& k, Args&&... args) {
+        return this->try_emplace_impl(k, static_cast<Args&&>(args)...);
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(Key&& k, Args&&... args) {
+        return this->try_emplace_impl(static_cast<Key&&>(k), static_cast<Args&&>(args)...);
+    }
+
+    template<class... Args, class = decltype(std::pair<Key, Mapped>(std::declval<Args&&>()...), void())>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        std::pair<Key, Mapped> t(static_cast<Args&&>(args)...);
+        return this->try_emplace_impl(static_cast<Key&&>(t.first), static_cast<Mapped&&>(t.second));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& x) {
+        return this->emplace(x);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& x) {
+        return this->emplace(static_cast<value_type&&>(x));
+    }
+
+    // A range goes straight into the main map, after the delta.
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    void insert(InputIterator first, InputIterator last) {
+        this->flush();
+        main_.insert(first, last);
+    }
+
+    void insert(std::initializer_list<value_type> il) {
+        this->insert(il.begin(), il.end());
+    }
+
+    template<class M>
+    std::pair<iterator, bool> insert_or_assign(const Key& k, M&& obj) {
+        auto result = this->try_emplace(k, static_cast<M&&>(obj));
+        if (!result.second) {
+            result.first->second = static_cast<M&&>(obj);
+        }
+        return result;
+    }
+
+    template<class M>
+    std::pair<iterator, bool> insert_or_assign(Key&& k, M&& obj) {
+        auto result = this->try_emplace(static_cast<Key&&>(k), static_cast<M&&>(obj));
+        if (!result.second) {
+            result.first->second = static_cast<M&&>(obj);
+        }
+        return result;
+    }
+
+    iterator erase(const_iterator position) {
+        size_t mi = position.private_impl_getmain();
+        size_t di = position.private_impl_getdelta();
+        if (position.private_impl_in_delta()) {
+            delta_.erase(delta_.begin() + static_cast<ptrdiff_t>(di));
+        } else {
+            main_.erase(main_.begin() + static_cast<ptrdiff_t>(mi));
+        }
+        return make_iterator(mi, di);
+    }
+
+    iterator erase(iterator position) {
+        return this->erase(const_iterator(position));
+    }
+
+    size_type erase(const Key& k) {
+        return delta_.erase(k) + main_.erase(k);
+    }
+
+    void swap(buffered_flat_map& m) noexcept
+#if defined(__cpp_lib_is_swappable)
+        (std::is_nothrow_swappable<base_map>::value && std::is_nothrow_swappable<Compare>::value)
+#endif
+    {
+        using std::swap;
+        swap(main_, m.main_);
+        swap(delta_, m.delta_);
+        swap(compare_, m.compare_);
+    }
+
+    void clear() noexcept {
+        main_.clear();
+        delta_.clear();
+    }
+
+    key_compare key_comp() const {
+        return compare_;
+    }
+
+    iterator find(const Key& k) {
+        return this->find_impl(*this, k);
+    }
+
+    const_iterator find(const Key& k) const {
+        return this->find_impl(*this, k);
+    }
+
+    size_type count(const Key& k) const {
+        return this->contains(k) ? 1 : 0;
+    }
+
+    bool contains(const Key& k) const {
+        return delta_.contains(k) || main_.contains(k);
+    }
+
+    iterator lower_bound(const Key& k) {
+        return make_iterator(main_.lower_bound(k) - main_.begin(), delta_.lower_bound(k) - delta_.begin());
+    }
+
+    const_iterator lower_bound(const Key& k) const {
+        return make_iterator(main_.lower_bound(k) - main_.begin(), delta_.lower_bound(k) - delta_.begin());
+    }
+
+    iterator upper_bound(const Key& k) {
+        return make_iterator(main_.upper_bound(k) - main_.begin(), delta_.upper_bound(k) - delta_.begin());
+    }
+
+    const_iterator upper_bound(const Key& k) const {
+        return make_iterator(main_.upper_bound(k) - main_.begin(), delta_.upper_bound(k) - delta_.begin());
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key& k) {
+        return {lower_bound(k), upper_bound(k)};
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key& k) const {
+        return {lower_bound(k), upper_bound(k)};
+    }
+
+    friend bool operator==(const buffered_flat_map& x, const buffered_flat_map& y) {
+        return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+    }
+
+    friend bool operator!=(const buffered_flat_map& x, const buffered_flat_map& y) {
+        return !(x == y);
+    }
+
+private:
+    iterator make_iterator(ptrdiff_t mi, ptrdiff_t di) {
+        return iterator(&main_, &delta_, &compare_, static_cast<size_t>(mi), static_cast<size_t>(di));
+    }
+
+    const_iterator make_iterator(ptrdiff_t mi, ptrdiff_t di) const {
+        return const_iterator(&main_, &delta_, &compare_, static_cast<size_t>(mi), static_cast<size_t>(di));
+    }
+
+    template<class Self>
+    static auto find_impl(Self& self, const Key& k) {
+        auto dit = self.delta_.find(k);
+        if (dit != self.delta_.end()) {
+            return self.make_iterator(self.main_.lower_bound(k) - self.main_.begin(), dit - self.delta_.begin());
+        }
+        auto mit = self.main_.find(k);
+        if (mit != self.main_.end()) {
+            return self.make_iterator(mit - self.main_.begin(), self.delta_.lower_bound(k) - self.delta_.begin());
+        }
+        return self.end();
+    }
+
+    template<class K, class... Args>
+    std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+        auto mit = main_.lower_bound(k);
+        if (mit != main_.end() && !bool(compare_(k, mit->first))) {
+            return {make_iterator(mit - main_.begin(), delta_.lower_bound(k) - delta_.begin()), false};
+        }
+        auto dit = delta_.lower_bound(k);
+        if (dit != delta_.end() && !bool(compare_(k, dit->first))) {
+            return {make_iterator(mit - main_.begin(), dit - delta_.begin()), false};
+        }
+        if (delta_.size() >= merge_threshold()) {
+            this->flush();
+            mit = main_.lower_bound(k);
+        }
+        dit = delta_.try_emplace(static_cast<K&&>(k), static_cast<Args&&>(args)...).first;
+        return {make_iterator(mit - main_.begin(), dit - delta_.begin()), true};
+    }
+
+    base_map main_;
+    base_map delta_;
+    Compare compare_;
+};
+
+template<class Key, class Mapped, class Compare, class KeyContainer, class MappedContainer>
+void swap(buffered_flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& x, buffered_flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& y) noexcept(noexcept(x.swap(y)))
+{
+    return x.swap(y);
+}
+
+} // namespace stdext
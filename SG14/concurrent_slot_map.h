@@ -0,0 +1,368 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// A slot_map variant for one writer thread and any number of reader threads.
+//
+// Readers never take a lock and never write to memory shared with other
+// readers or with the writer's hot data: each registered reader owns one
+// cache line in which it publishes the epoch it is reading in.
+//
+// Each slot holds an atomic generation and an atomic pointer to its value.
+// erase() bumps the generation before unlinking the value, so a reader
+// holding a stale key fails the generation check. A reader that loaded the
+// pointer just before the erase keeps a valid object: erased values are
+// retired and only destroyed once every reader has moved past the epoch in
+// which they were unlinked.
+//
+// Slots live in chunks of doubling size that are never moved or freed while
+// the map is alive, so growing the map never invalidates a reader.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifndef SLOT_MAP_THROW_EXCEPTION
+#include <stdexcept>
+#define SLOT_MAP_THROW_EXCEPTION(type, ...) throw type(__VA_ARGS__)
+#endif
+
+#ifndef SG14_CACHE_LINE_SIZE
+#define SG14_CACHE_LINE_SIZE 64
+#endif
+
+namespace stdext {
+
+namespace concurrent_slot_map_detail {
+
+// The position of the highest set bit of n, which must be non-zero.
+inline unsigned log2_floor(std::size_t n)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(n));
+#else
+    unsigned result = 0;
+    while (n >>= 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+} // namespace concurrent_slot_map_detail
+
+template<
+    class T,
+    class Key = std::pair<unsigned, unsigned>
+>
+class concurrent_slot_map
+{
+#if __cplusplus >= 201703L
+    static constexpr auto get_index(const Key& k) { const auto& [idx, gen] = k; return idx; }
+    static constexpr auto get_generation(const Key& k) { const auto& [idx, gen] = k; return gen; }
+#else
+    static constexpr auto get_index(const Key& k) { using std::get; return get<0>(k); }
+    static constexpr auto get_generation(const Key& k) { using std::get; return get<1>(k); }
+#endif
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using size_type = std::size_t;
+
+    using key_index_type = decltype(concurrent_slot_map::get_index(std::declval<Key>()));
+    using key_generation_type = decltype(concurrent_slot_map::get_generation(std::declval<Key>()));
+
+    class reader;
+    class read_guard;
+
+private:
+    struct slot {
+        std::atomic<key_generation_type> generation{};
+        std::atomic<T*> value{nullptr};
+    };
+
+    // Padded rather than aligned, so that C++14 can allocate an array of
+    // them; either way no two records' atomics share a cache line.
+    struct reader_record {
+        std::atomic<std::uint64_t> epoch{0};  // 0 means "not reading"
+        std::atomic<bool> in_use{false};
+        char padding[SG14_CACHE_LINE_SIZE - sizeof(std::atomic<std::uint64_t>) - sizeof(std::atomic<bool>)];
+    };
+
+    static constexpr size_type first_chunk_size = 64;
+    static constexpr unsigned max_chunks = sizeof(size_type) * 8 - 6;
+
+public:
+    // A read_guard pins the current epoch for its reader. Pointers returned
+    // by find() stay valid until the guard is destroyed, even if the writer
+    // erases the element in the meantime.
+    class read_guard {
+    public:
+        read_guard(read_guard&& rhs) noexcept : map_(rhs.map_), record_(rhs.record_) { rhs.record_ = nullptr; }
+        read_guard(const read_guard&) = delete;
+        read_guard& operator=(const read_guard&) = delete;
+        ~read_guard() {
+            if (record_ != nullptr) {
+                record_->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        // Returns nullptr if the key is out of range or expired.
+        // O(1) time and space complexity.
+        //
+        const T *find(const key_type& key) const { return map_->find_in_epoch(key); }
+        bool contains(const key_type& key) const { return this->find(key) != nullptr; }
+
+    private:
+        friend class reader;
+        read_guard(const concurrent_slot_map *map, reader_record *record) : map_(map), record_(record) {
+            record_->epoch.store(map_->global_epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            // Make the pin visible to the writer before we read any slot.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        const concurrent_slot_map *map_;
+        reader_record *record_;
+    };
+
+    // Each reader thread registers once and then pins an epoch around every
+    // batch of lookups. A reader must not be used by two threads at once,
+    // and may have at most one read_guard alive at a time.
+    class reader {
+    public:
+        reader(reader&& rhs) noexcept : map_(rhs.map_), record_(rhs.record_) { rhs.record_ = nullptr; }
+        reader(const reader&) = delete;
+        reader& operator=(const reader&) = delete;
+        ~reader() {
+            if (record_ != nullptr) {
+                record_->in_use.store(false, std::memory_order_release);
+            }
+        }
+
+        read_guard pin() const { return read_guard(map_, record_); }
+
+    private:
+        friend class concurrent_slot_map;
+        reader(const concurrent_slot_map *map, reader_record *record) : map_(map), record_(record) {}
+
+        const concurrent_slot_map *map_;
+        reader_record *record_;
+    };
+
+    explicit concurrent_slot_map(size_type max_readers = 64)
+        : readers_(new reader_record[max_readers]), max_readers_(max_readers) {}
+    concurrent_slot_map(const concurrent_slot_map&) = delete;
+    concurrent_slot_map& operator=(const concurrent_slot_map&) = delete;
+
+    // No reader may be registered when the map is destroyed.
+    ~concurrent_slot_map() {
+        for (auto&& r : retired_) {
+            delete r.first;
+        }
+        for (unsigned c = 0; c < max_chunks; ++c) {
+            slot *chunk = chunks_[c].load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                break;
+            }
+            size_type n = first_chunk_size << c;
+            for (size_type i = 0; i < n; ++i) {
+                delete chunk[i].value.load(std::memory_order_relaxed);
+            }
+            delete[] chunk;
+        }
+    }
+
+    // Thread-safe. Throws std::length_error if max_readers readers
+    // are already registered.
+    reader make_reader() const {
+        for (size_type i = 0; i < max_readers_; ++i) {
+            bool expected = false;
+            if (!readers_[i].in_use.load(std::memory_order_relaxed) &&
+                readers_[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return reader(this, &readers_[i]);
+            }
+        }
+        SLOT_MAP_THROW_EXCEPTION(std::length_error, "make_reader");
+    }
+
+    // Everything below is for the single writer thread only.
+
+    constexpr bool empty() const { return size_ == 0; }
+    constexpr size_type size() const { return size_; }
+    size_type slot_count() const { return slot_count_.load(std::memory_order_relaxed); }
+
+    // The writer may look up values without pinning an epoch, since only the
+    // writer ever destroys them. Modifying a value that readers may be
+    // reading is only safe if T synchronizes those accesses itself.
+    // O(1) time and space complexity.
+    //
+    T *find(const key_type& key) { return const_cast<T*>(this->find_in_epoch(key)); }
+
+    // These operations have O(1) time and space complexity, plus one
+    // allocation for the value and, rarely, one for a new chunk of slots.
+    //
+    key_type insert(const mapped_type& value)   { return this->emplace(value); }
+    key_type insert(mapped_type&& value)        { return this->emplace(std::move(value)); }
+
+    template<class... Args> key_type emplace(Args&&... args) {
+        std::unique_ptr<T> value(new T(std::forward<Args>(args)...));
+        if (free_slots_.empty()) {
+            this->grow();
+        }
+        key_index_type idx = free_slots_.front();
+        free_slots_.pop_front();
+        slot& s = this->slot_at(idx);
+        key_generation_type gen = s.generation.load(std::memory_order_relaxed);
+        s.value.store(value.release(), std::memory_order_release);
+        ++size_;
+        return key_type{idx, gen};
+    }
+
+    // erase() has O(1) amortized time complexity: every reclaim_threshold
+    // erasures it scans the registered readers and destroys the retired
+    // values that no reader can still see.
+    //
+    size_type erase(const key_type& key) {
+        auto idx = static_cast<size_type>(get_index(key));
+        if (idx >= slot_count_.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        slot& s = this->slot_at(idx);
+        key_generation_type gen = s.generation.load(std::memory_order_relaxed);
+        if (gen != get_generation(key)) {
+            return 0;
+        }
+        // A free slot also matches a key with its current generation, which
+        // insert has not issued yet.
+        if (s.value.load(std::memory_order_relaxed) == nullptr) {
+            return 0;
+        }
+        // Expire the key first, so that a reader that sees the new value of
+        // this slot after a later insert cannot also match the old generation.
+        ++gen;
+        s.generation.store(gen, std::memory_order_release);
+        T *old = s.value.exchange(nullptr, std::memory_order_acq_rel);
+        retired_.emplace_back(old, global_epoch_.load(std::memory_order_relaxed));
+        global_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        free_slots_.push_back(static_cast<key_index_type>(idx));
+        --size_;
+        if (retired_.size() >= reclaim_threshold) {
+            this->reclaim();
+        }
+        return 1;
+    }
+
+    // Destroys every retired value that no pinned reader can still observe.
+    // O(r + n) time, for r registered readers and n retired values.
+    //
+    void reclaim() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t oldest_pinned = global_epoch_.load(std::memory_order_relaxed);
+        for (size_type i = 0; i < max_readers_; ++i) {
+            std::uint64_t e = readers_[i].epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < oldest_pinned) {
+                oldest_pinned = e;
+            }
+        }
+        // A value retired in epoch e may still be seen by a reader pinned at e.
+        auto keep = std::partition(retired_.begin(), retired_.end(), [&](const std::pair<T*, std::uint64_t>& r) {
+            return r.second >= oldest_pinned;
+        });
+        for (auto it = keep; it != retired_.end(); ++it) {
+            delete it->first;
+        }
+        retired_.erase(keep, retired_.end());
+    }
+
+    constexpr size_type retired_count() const { return retired_.size(); }
+
+private:
+    static constexpr size_type reclaim_threshold = 64;
+
+    const T *find_in_epoch(const key_type& key) const {
+        auto idx = static_cast<size_type>(get_index(key));
+        if (idx >= slot_count_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        const slot& s = this->slot_at(idx);
+        key_generation_type gen = s.generation.load(std::memory_order_acquire);
+        if (gen != get_generation(key)) {
+            return nullptr;
+        }
+        const T *value = s.value.load(std::memory_order_acquire);
+        // If the slot was erased and refilled since we checked the generation,
+        // the pointer we loaded belongs to a different key.
+        if (s.generation.load(std::memory_order_acquire) != gen) {
+            return nullptr;
+        }
+        return value;
+    }
+
+    slot& slot_at(size_type idx) const {
+        size_type p = idx + first_chunk_size;
+        unsigned high = concurrent_slot_map_detail::log2_floor(p);
+        unsigned chunk = high - concurrent_slot_map_detail::log2_floor(first_chunk_size);
+        return chunks_[chunk].load(std::memory_order_acquire)[p - (size_type(1) << high)];
+    }
+
+    void grow() {
+        size_type n = first_chunk_size << num_chunks_;
+        slot *chunk = new slot[n];
+        chunks_[num_chunks_].store(chunk, std::memory_order_release);
+        ++num_chunks_;
+        size_type first = slot_count_.load(std::memory_order_relaxed);
+        for (size_type i = 0; i < n; ++i) {
+            free_slots_.push_back(static_cast<key_index_type>(first + i));
+        }
+        slot_count_.store(first + n, std::memory_order_release);
+    }
+
+    // Read by readers, rarely written.
+    std::atomic<slot*> chunks_[max_chunks] = {};
+    std::atomic<size_type> slot_count_{0};
+    std::unique_ptr<reader_record[]> readers_;
+    size_type max_readers_;
+
+    // Read by readers on every pin, written on every erase.
+    char padding1_[SG14_CACHE_LINE_SIZE];
+    std::atomic<std::uint64_t> global_epoch_{1};
+    char padding2_[SG14_CACHE_LINE_SIZE];
+
+    // Writer only.
+    unsigned num_chunks_ = 0;
+    size_type size_ = 0;
+    std::deque<key_index_type> free_slots_;  // FIFO, to spread generation increments across slots
+    std::vector<std::pair<T*, std::uint64_t>> retired_;
+};
+
+} // namespace stdext
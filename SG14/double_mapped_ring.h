@@ -0,0 +1,154 @@
+#pragma once
+
+#include "ring.h"
+
+#include <cstddef>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace sg14
+{
+#if defined(__linux__)
+	// A byte buffer whose pages are mapped twice, back to back, in virtual
+	// memory: for every i in [0, size()), begin()[i] and begin()[i + size()]
+	// are the same byte. A ring_span<char> over [begin(), end()) can then hand
+	// out any run of up to size() bytes starting anywhere in the buffer as a
+	// single contiguous pointer, with no split at the wrap point.
+	// The size is rounded up to a whole number of pages.
+	class double_mapped_buffer
+	{
+	public:
+		explicit double_mapped_buffer(std::size_t min_size);
+		double_mapped_buffer(double_mapped_buffer&& rhs) noexcept;
+		double_mapped_buffer& operator=(double_mapped_buffer&& rhs) noexcept;
+		double_mapped_buffer(const double_mapped_buffer&) = delete;
+		double_mapped_buffer& operator=(const double_mapped_buffer&) = delete;
+		~double_mapped_buffer();
+
+		char* begin() const noexcept;
+		char* end() const noexcept;
+		std::size_t size() const noexcept;
+
+	private:
+		char* m_data;
+		std::size_t m_size;
+	};
+#endif
+
+	// These require that r views a double_mapped_buffer, so that the bytes
+	// past its end mirror the bytes at its start.
+	// contiguous_readable returns all of r's elements, front first.
+	// contiguous_writable returns all of r's free slots after back(); fill a
+	// prefix of it and call r.commit_back(n).
+	template<class Popper>
+	ring_segment<char> contiguous_readable(ring_span<char, Popper>& r) noexcept;
+	template<class Popper>
+	ring_segment<char> contiguous_writable(ring_span<char, Popper>& r) noexcept;
+} // namespace sg14
+
+// Sample implementation
+
+#if defined(__linux__)
+inline sg14::double_mapped_buffer::double_mapped_buffer(std::size_t min_size)
+	: m_data(nullptr)
+	, m_size(0)
+{
+	std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	std::size_t size = (min_size == 0) ? page : ((min_size + page - 1) / page * page);
+
+	int fd = ::memfd_create("sg14_double_mapped_buffer", MFD_CLOEXEC);
+	if (fd < 0)
+	{
+		throw std::system_error(errno, std::system_category(), "memfd_create");
+	}
+	if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+	{
+		int err = errno;
+		::close(fd);
+		throw std::system_error(err, std::system_category(), "ftruncate");
+	}
+
+	// Reserve both halves at once so nothing else can land in between,
+	// then map the file over each half.
+	void* base = ::mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED)
+	{
+		int err = errno;
+		::close(fd);
+		throw std::system_error(err, std::system_category(), "mmap");
+	}
+	char* first = static_cast<char*>(base);
+	if (::mmap(first, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+		::mmap(first + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+	{
+		int err = errno;
+		::munmap(base, 2 * size);
+		::close(fd);
+		throw std::system_error(err, std::system_category(), "mmap");
+	}
+	// The mappings keep the memory alive.
+	::close(fd);
+
+	m_data = first;
+	m_size = size;
+}
+
+inline sg14::double_mapped_buffer::double_mapped_buffer(double_mapped_buffer&& rhs) noexcept
+	: m_data(rhs.m_data)
+	, m_size(rhs.m_size)
+{
+	rhs.m_data = nullptr;
+	rhs.m_size = 0;
+}
+
+inline sg14::double_mapped_buffer& sg14::double_mapped_buffer::operator=(double_mapped_buffer&& rhs) noexcept
+{
+	using std::swap;
+	swap(m_data, rhs.m_data);
+	swap(m_size, rhs.m_size);
+	return *this;
+}
+
+inline sg14::double_mapped_buffer::~double_mapped_buffer()
+{
+	if (m_data != nullptr)
+	{
+		::munmap(m_data, 2 * m_size);
+	}
+}
+
+inline char* sg14::double_mapped_buffer::begin() const noexcept
+{
+	return m_data;
+}
+
+inline char* sg14::double_mapped_buffer::end() const noexcept
+{
+	return m_data + m_size;
+}
+
+inline std::size_t sg14::double_mapped_buffer::size() const noexcept
+{
+	return m_size;
+}
+#endif
+
+template<class Popper>
+sg14::ring_segment<char> sg14::contiguous_readable(sg14::ring_span<char, Popper>& r) noexcept
+{
+	auto segments = r.readable_segments();
+	return ring_segment<char>(segments.first.data(), r.size());
+}
+
+template<class Popper>
+sg14::ring_segment<char> sg14::contiguous_writable(sg14::ring_span<char, Popper>& r) noexcept
+{
+	auto segments = r.writable_segments();
+	return ring_segment<char>(segments.first.data(), r.capacity() - r.size());
+}
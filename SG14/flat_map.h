@@ -29,6 +29,8 @@
 // This is an implementation of the proposed "std::flat_map" as specified in
 // http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2019/p0429r6.pdf
 
+#include "flat_search.h"
+
 #include <stddef.h>
 #include <algorithm>
 #include <functional>
@@ -118,45 +120,119 @@ namespace flatmap_detail {
         (void)dummy;
     }
 
-    template<class Predicate, class Head, class... Rest>
-    size_t partition_together(Predicate& pred, size_t left, size_t right, Head head, const Rest... rest) {
-        while (left < right) {
-            while (left != right && pred(*(head + left))) ++left;
-            while (left != right && !pred(*(head + (right-1)))) --right;
-            if (left + 1 < right) {
-                flatmap_detail::swap_together(left, right-1, head, rest...);
-                ++left;
-                --right;
+    template<class Compare, class Head, class... Rest>
+    void insertion_sort_together(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+        for (size_t i = left + 1; i < right; ++i) {
+            for (size_t j = i; j > left && less(*(head + j), *(head + (j-1))); --j) {
+                flatmap_detail::swap_together(j, j-1, head, rest...);
             }
         }
-        return right;
     }
 
     template<class Compare, class Head, class... Rest>
-    void sort_together(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
-        if (right - left >= 3) {
-            size_t pivot_idx = left + (right - left) / 2;
-            // Swap the pivot element all the way to the right.
-            if (pivot_idx != right - 1) {
-                flatmap_detail::swap_together(pivot_idx, right-1, head, rest...);
+    void sift_down_together(Compare& less, size_t first, size_t i, size_t n, Head head, Rest... rest) {
+        while (2*i + 1 < n) {
+            size_t child = 2*i + 1;
+            if (child + 1 < n && less(*(head + (first+child)), *(head + (first+child+1)))) {
+                ++child;
             }
-            const auto& pivot_elt = *(head + (right-1));
-            auto less_than_pivot = [&](const auto& x) -> bool {
-                return less(x, pivot_elt);
-            };
-            size_t correct_pivot_idx = flatmap_detail::partition_together(less_than_pivot, left, right-1, head, rest...);
-            if (correct_pivot_idx != right-1) {
-                flatmap_detail::swap_together(correct_pivot_idx, right-1, head, rest...);
+            if (!less(*(head + (first+i)), *(head + (first+child)))) {
+                break;
+            }
+            flatmap_detail::swap_together(first+i, first+child, head, rest...);
+            i = child;
+        }
+    }
+
+    template<class Compare, class Head, class... Rest>
+    void heap_sort_together(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+        size_t n = right - left;
+        for (size_t i = n / 2; i-- != 0; ) {
+            flatmap_detail::sift_down_together(less, left, i, n, head, rest...);
+        }
+        for (size_t end = n; end > 1; --end) {
+            flatmap_detail::swap_together(left, left + end - 1, head, rest...);
+            flatmap_detail::sift_down_together(less, left, 0, end - 1, head, rest...);
+        }
+    }
+
+    // Orders the elements at a, b, c so that the median ends up at b.
+    template<class Compare, class Head, class... Rest>
+    void sort3_together(Compare& less, size_t a, size_t b, size_t c, Head head, Rest... rest) {
+        if (less(*(head + b), *(head + a))) {
+            flatmap_detail::swap_together(a, b, head, rest...);
+        }
+        if (less(*(head + c), *(head + b))) {
+            flatmap_detail::swap_together(b, c, head, rest...);
+            if (less(*(head + b), *(head + a))) {
+                flatmap_detail::swap_together(a, b, head, rest...);
+            }
+        }
+    }
+
+    // Partitions [left, right) around the pivot at left, and returns the
+    // pivot's final position. Both scans stop on elements equal to the
+    // pivot, so runs of duplicates are split evenly.
+    template<class Compare, class Head, class... Rest>
+    size_t partition_together(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+        const auto& pivot = *(head + left);
+        size_t i = left;
+        size_t j = right;
+        while (true) {
+            do { ++i; } while (i < right && less(*(head + i), pivot));
+            do { --j; } while (less(pivot, *(head + j)));
+            if (i >= j) {
+                break;
+            }
+            flatmap_detail::swap_together(i, j, head, rest...);
+        }
+        flatmap_detail::swap_together(left, j, head, rest...);
+        return j;
+    }
+
+    // An introsort over [left, right) that applies every swap to all the
+    // ranges at once: median-of-three pivots (a ninther on large ranges),
+    // insertion sort on short ranges, and heapsort once the recursion gets
+    // deeper than 2*log2(n). It recurses only into the smaller side.
+    template<class Compare, class Head, class... Rest>
+    void introsort_together(Compare& less, size_t left, size_t right, size_t depth, Head head, Rest... rest) {
+        constexpr size_t insertion_sort_threshold = 16;
+        constexpr size_t ninther_threshold = 128;
+        while (right - left > insertion_sort_threshold) {
+            if (depth == 0) {
+                flatmap_detail::heap_sort_together(less, left, right, head, rest...);
+                return;
+            }
+            --depth;
+            size_t mid = left + (right - left) / 2;
+            if (right - left > ninther_threshold) {
+                flatmap_detail::sort3_together(less, left, mid, right-1, head, rest...);
+                flatmap_detail::sort3_together(less, left+1, mid-1, right-2, head, rest...);
+                flatmap_detail::sort3_together(less, left+2, mid+1, right-3, head, rest...);
+                flatmap_detail::sort3_together(less, mid-1, mid, mid+1, head, rest...);
+            } else {
+                flatmap_detail::sort3_together(less, left, mid, right-1, head, rest...);
             }
-            flatmap_detail::sort_together(less, left, correct_pivot_idx, head, rest...);
-            flatmap_detail::sort_together(less, correct_pivot_idx+1, right, head, rest...);
-        } else if (right - left == 2) {
-            if (less(*(head + left), *(head + (left+1)))) {
-                // nothing to do
+            flatmap_detail::swap_together(left, mid, head, rest...);
+            size_t p = flatmap_detail::partition_together(less, left, right, head, rest...);
+            if (p - left < right - (p + 1)) {
+                flatmap_detail::introsort_together(less, left, p, depth, head, rest...);
+                left = p + 1;
             } else {
-                flatmap_detail::swap_together(left, left+1, head, rest...);
+                flatmap_detail::introsort_together(less, p + 1, right, depth, head, rest...);
+                right = p;
             }
         }
+        flatmap_detail::insertion_sort_together(less, left, right, head, rest...);
+    }
+
+    template<class Compare, class Head, class... Rest>
+    void sort_together(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+        size_t depth = 0;
+        for (size_t n = right - left; n > 1; n >>= 1) {
+            depth += 2;
+        }
+        flatmap_detail::introsort_together(less, left, right, depth, head, rest...);
     }
 
     template<class Compare, class Head, class... Rest>
@@ -637,30 +713,15 @@ public:
     template<class InputIterator,
              class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
     void insert(InputIterator first, InputIterator last) {
-        // TODO: if we're inserting lots of elements, stick them at the end and then sort
-        while (first != last) {
-            this->insert(*first);
-            ++first;
-        }
+        size_type old_size = this->append_impl(first, last);
+        this->merge_tail_impl(old_size, false);
     }
 
     template<class InputIterator,
              class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
     void insert(stdext::sorted_unique_t, InputIterator first, InputIterator last) {
-        // TODO: if InputIterator is bidirectional, this loop should (go backward??)
-        // TODO: if we're inserting lots of elements, stick them at the end and then sort
-        auto it = begin();
-        while (first != last) {
-            std::pair<Key, Mapped> t(*first);
-            it = std::partition_point(it, this->end(), [&](const auto& elt) {
-                return bool(compare_(elt.first, t.first));
-            });
-            if (it == this->end() || bool(compare_(t.first, it->first))) {
-                it = this->emplace(it, std::move(t));
-            }
-            ++it;
-            ++first;
-        }
+        size_type old_size = this->append_impl(first, last);
+        this->merge_tail_impl(old_size, true);
     }
 
     void insert(std::initializer_list<value_type> il) {
@@ -699,7 +760,7 @@ public:
 
     template<class... Args>
     std::pair<iterator, bool> try_emplace(const Key& k, Args&&... args) {
-        auto kit = std::lower_bound(c_.keys.begin(), c_.keys.end(), k, std::ref(compare_));
+        auto kit = flat_search_detail::lower_bound(c_.keys, k, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         if (kit == c_.keys.end() || compare_(k, *kit)) {
             kit = c_.keys.insert(kit, k);
@@ -713,7 +774,7 @@ public:
 
     template<class... Args>
     std::pair<iterator, bool> try_emplace(Key&& k, Args&&... args) {
-        auto kit = std::lower_bound(c_.keys.begin(), c_.keys.end(), k, std::ref(compare_));
+        auto kit = flat_search_detail::lower_bound(c_.keys, k, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         if (kit == c_.keys.end() || compare_(k, *kit)) {
             kit = c_.keys.insert(kit, static_cast<Key&&>(k));
@@ -810,6 +871,16 @@ public:
         return 0;
     }
 
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent,
+             class = typename std::enable_if<!std::is_convertible<const K&, iterator>::value && !std::is_convertible<const K&, const_iterator>::value>::type>
+    size_type erase(const K& x) {
+        auto its = this->equal_range(x);
+        size_type n = static_cast<size_type>(its.second - its.first);
+        this->erase(its.first, its.second);
+        return n;
+    }
+
     iterator erase(const_iterator first, const_iterator last) {
         auto kfirst = first.private_impl_getkey();
         auto vfirst = first.private_impl_getmapped();
@@ -896,7 +967,8 @@ public:
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     size_type count(const K& x) const {
-        return this->contains(x) ? 1 : 0;
+        auto its = this->equal_range(x);
+        return static_cast<size_type>(its.second - its.first);
     }
 
     bool contains(const Key& k) const {
@@ -910,17 +982,13 @@ public:
     }
 
     iterator lower_bound(const Key& k) {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, k));
-        });
+        auto kit = flat_search_detail::lower_bound(c_.keys, k, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
 
     const_iterator lower_bound(const Key& k) const {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, k));
-        });
+        auto kit = flat_search_detail::lower_bound(c_.keys, k, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
@@ -928,9 +996,7 @@ public:
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     iterator lower_bound(const K& x) {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, x));
-        });
+        auto kit = flat_search_detail::lower_bound(c_.keys, x, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
@@ -938,25 +1004,19 @@ public:
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     const_iterator lower_bound(const K& x) const {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, x));
-        });
+        auto kit = flat_search_detail::lower_bound(c_.keys, x, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
 
     iterator upper_bound(const Key& k) {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return !bool(compare_(k, elt));
-        });
+        auto kit = flat_search_detail::upper_bound(c_.keys, k, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
 
     const_iterator upper_bound(const Key& k) const {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return !bool(compare_(k, elt));
-        });
+        auto kit = flat_search_detail::upper_bound(c_.keys, k, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
@@ -964,9 +1024,7 @@ public:
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     iterator upper_bound(const K& x) {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return !bool(compare_(x, elt));
-        });
+        auto kit = flat_search_detail::upper_bound(c_.keys, x, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
@@ -974,20 +1032,15 @@ public:
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     const_iterator upper_bound(const K& x) const {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return !bool(compare_(x, elt));
-        });
+        auto kit = flat_search_detail::upper_bound(c_.keys, x, compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
 
     std::pair<iterator, iterator> equal_range(const Key& k) {
-        auto kit1 = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, k));
-        });
-        auto kit2 = std::partition_point(kit1, c_.keys.end(), [&](const auto& elt) {
-            return !bool(compare_(k, elt));
-        });
+        auto kits = flat_search_detail::equal_range(c_.keys, k, compare_);
+        auto kit1 = kits.first;
+        auto kit2 = kits.second;
         auto vit1 = c_.values.begin() + (kit1 - c_.keys.begin());
         auto vit2 = c_.values.begin() + (kit2 - c_.keys.begin());
         return {
@@ -997,12 +1050,9 @@ public:
     }
 
     std::pair<const_iterator, const_iterator> equal_range(const Key& k) const {
-        auto kit1 = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, k));
-        });
-        auto kit2 = std::partition_point(kit1, c_.keys.end(), [&](const auto& elt) {
-            return !bool(compare_(k, elt));
-        });
+        auto kits = flat_search_detail::equal_range(c_.keys, k, compare_);
+        auto kit1 = kits.first;
+        auto kit2 = kits.second;
         auto vit1 = c_.values.begin() + (kit1 - c_.keys.begin());
         auto vit2 = c_.values.begin() + (kit2 - c_.keys.begin());
         return {
@@ -1014,12 +1064,9 @@ public:
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     std::pair<iterator, iterator> equal_range(const K& x) {
-        auto kit1 = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, x));
-        });
-        auto kit2 = std::partition_point(kit1, c_.keys.end(), [&](const auto& elt) {
-            return !bool(compare_(x, elt));
-        });
+        auto kits = flat_search_detail::equal_range_heterogeneous(c_.keys, x, compare_);
+        auto kit1 = kits.first;
+        auto kit2 = kits.second;
         auto vit1 = c_.values.begin() + (kit1 - c_.keys.begin());
         auto vit2 = c_.values.begin() + (kit2 - c_.keys.begin());
         return {
@@ -1031,12 +1078,9 @@ public:
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     std::pair<const_iterator, const_iterator> equal_range(const K& x) const {
-        auto kit1 = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, x));
-        });
-        auto kit2 = std::partition_point(kit1, c_.keys.end(), [&](const auto& elt) {
-            return !bool(compare_(x, elt));
-        });
+        auto kits = flat_search_detail::equal_range_heterogeneous(c_.keys, x, compare_);
+        auto kit1 = kits.first;
+        auto kit2 = kits.second;
         auto vit1 = c_.values.begin() + (kit1 - c_.keys.begin());
         auto vit2 = c_.values.begin() + (kit2 - c_.keys.begin());
         return {
@@ -1045,7 +1089,150 @@ public:
         };
     }
 
+    // Batched lookups: find_many writes find(x) for each probe x of
+    // [first, last) to out, contains_many writes contains(x), and
+    // count_many returns how many of the probes are present.
+    // A sorted batch is merged against the keys by galloping forward from
+    // each result; an unsorted batch is searched in interleaved blocks.
+    template<class InputIterator, class OutputIterator>
+    OutputIterator find_many(InputIterator first, InputIterator last, OutputIterator out) {
+        auto kbegin = c_.keys.begin();
+        auto vbegin = c_.values.begin();
+        flat_search_detail::search_many(c_.keys, first, last, compare_, [&](size_t i, bool found) {
+            ptrdiff_t d = found ? static_cast<ptrdiff_t>(i) : static_cast<ptrdiff_t>(size());
+            *out = iterator(flatmap_detail::make_iterator(kbegin + d, vbegin + d));
+            ++out;
+        });
+        return out;
+    }
+
+    template<class InputIterator, class OutputIterator>
+    OutputIterator find_many(InputIterator first, InputIterator last, OutputIterator out) const {
+        auto kbegin = c_.keys.begin();
+        auto vbegin = c_.values.begin();
+        flat_search_detail::search_many(c_.keys, first, last, compare_, [&](size_t i, bool found) {
+            ptrdiff_t d = found ? static_cast<ptrdiff_t>(i) : static_cast<ptrdiff_t>(size());
+            *out = const_iterator(flatmap_detail::make_iterator(kbegin + d, vbegin + d));
+            ++out;
+        });
+        return out;
+    }
+
+    template<class InputIterator, class OutputIterator>
+    OutputIterator contains_many(InputIterator first, InputIterator last, OutputIterator out) const {
+        flat_search_detail::search_many(c_.keys, first, last, compare_, [&](size_t, bool found) {
+            *out = found;
+            ++out;
+        });
+        return out;
+    }
+
+    template<class InputIterator>
+    size_type count_many(InputIterator first, InputIterator last) const {
+        size_type count = 0;
+        flat_search_detail::search_many(c_.keys, first, last, compare_, [&](size_t, bool found) {
+            count += found;
+        });
+        return count;
+    }
+
 private:
+    // Appends [first, last) to the end of both containers, returning the
+    // previous size. If an element cannot be appended, the containers are
+    // restored to that size.
+    template<class InputIterator>
+    size_type append_impl(InputIterator first, InputIterator last) {
+        size_type old_size = size();
+        try {
+            for (; first != last; ++first) {
+                std::pair<Key, Mapped> t(*first);
+                c_.keys.insert(c_.keys.end(), static_cast<Key&&>(t.first));
+                c_.values.insert(c_.values.end(), static_cast<Mapped&&>(t.second));
+            }
+        } catch (...) {
+            c_.keys.erase(c_.keys.begin() + old_size, c_.keys.end());
+            c_.values.erase(c_.values.begin() + old_size, c_.values.end());
+            throw;
+        }
+        return old_size;
+    }
+
+    // The first old_size elements are sorted and unique; the rest were just
+    // appended. Sorts the new tail (unless tail_sorted), drops the tail's
+    // duplicates and the keys already present, then merges it in from the
+    // back through a buffer holding only the tail: O(N + M log M) overall.
+    // Until the merge itself starts, only the tail has been touched, so a
+    // throw up to then (including failing to allocate the buffer) drops
+    // just the tail; a throw during the merge leaves the map empty.
+    void merge_tail_impl(size_type old_size, bool tail_sorted) {
+        std::vector<Key> kbuf;
+        std::vector<Mapped> vbuf;
+        size_type w = old_size;
+        try {
+            size_type total = c_.keys.size();
+            auto kfirst = c_.keys.begin();
+            auto vfirst = c_.values.begin();
+            if (!tail_sorted) {
+                flatmap_detail::sort_together(compare_, old_size, total, kfirst, vfirst);
+            }
+            size_type head = 0;
+            for (size_type r = old_size; r < total; ++r) {
+                const Key& k = kfirst[r];
+                if (w != old_size && !bool(compare_(kfirst[w - 1], k))) {
+                    continue;  // a duplicate within the tail
+                }
+                while (head != old_size && bool(compare_(kfirst[head], k))) {
+                    ++head;
+                }
+                if (head != old_size && !bool(compare_(k, kfirst[head]))) {
+                    continue;  // already in the map
+                }
+                if (w != r) {
+                    kfirst[w] = static_cast<Key&&>(kfirst[r]);
+                    vfirst[w] = static_cast<Mapped&&>(vfirst[r]);
+                }
+                ++w;
+            }
+            c_.keys.erase(kfirst + w, c_.keys.end());
+            c_.values.erase(vfirst + w, c_.values.end());
+            kfirst = c_.keys.begin();
+            vfirst = c_.values.begin();
+            if (old_size == 0 || w == old_size || bool(compare_(kfirst[old_size - 1], kfirst[old_size]))) {
+                return;
+            }
+            kbuf.reserve(w - old_size);
+            vbuf.reserve(w - old_size);
+            kbuf.assign(std::make_move_iterator(kfirst + old_size), std::make_move_iterator(kfirst + w));
+            vbuf.assign(std::make_move_iterator(vfirst + old_size), std::make_move_iterator(vfirst + w));
+        } catch (...) {
+            c_.keys.erase(c_.keys.begin() + old_size, c_.keys.end());
+            c_.values.erase(c_.values.begin() + old_size, c_.values.end());
+            throw;
+        }
+        try {
+            auto kfirst = c_.keys.begin();
+            auto vfirst = c_.values.begin();
+            size_type i = old_size;
+            size_type j = kbuf.size();
+            size_type out = w;
+            while (j != 0) {
+                --out;
+                if (i != 0 && bool(compare_(kbuf[j - 1], kfirst[i - 1]))) {
+                    --i;
+                    kfirst[out] = static_cast<Key&&>(kfirst[i]);
+                    vfirst[out] = static_cast<Mapped&&>(vfirst[i]);
+                } else {
+                    --j;
+                    kfirst[out] = static_cast<Key&&>(kbuf[j]);
+                    vfirst[out] = static_cast<Mapped&&>(vbuf[j]);
+                }
+            }
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
     void sort_and_unique_impl() {
         flatmap_detail::sort_together(compare_, c_.keys, c_.values);
         auto kit = flatmap_detail::unique_helper(c_.keys.begin(), c_.keys.end(), c_.values.begin(), compare_);
@@ -0,0 +1,609 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+// Searching the sorted key container of flat_map and flat_set. The generic
+// path is a plain partition_point; arithmetic keys held contiguously and
+// ordered by std::less take a branchless path instead, and containers
+// that provide bound_index (such as front_coded_strings) search themselves.
+//
+// Also the SIMD intersection kernel behind flat_set's set algebra.
+//
+// Also the Eytzinger layout used by frozen_flat_set and frozen_flat_map:
+// the keys are stored in breadth-first order of the implicit binary search
+// tree, so that the nodes visited by a search are packed at the front.
+
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SG14_FLAT_SEARCH_SSE2 1
+#include <emmintrin.h>
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+#ifndef SG14_CACHE_LINE_SIZE
+#define SG14_CACHE_LINE_SIZE 64
+#endif
+
+namespace stdext {
+
+namespace flat_search_detail {
+
+    template<class...> using void_t = void;
+
+    template<class Container, class = void>
+    struct has_contiguous_data : std::false_type {};
+    template<class Container>
+    struct has_contiguous_data<Container, void_t<decltype(std::declval<const Container&>().data())>> : std::is_same<
+        decltype(std::declval<const Container&>().data()),
+        const typename Container::value_type*
+    > {};
+
+    // The fast path is only taken when it cannot change the answer: the
+    // comparison is the built-in operator< on the key type itself.
+    template<class Container, class Compare, class K, class Key = typename Container::value_type>
+    using uses_fast_search = std::integral_constant<bool,
+        std::is_arithmetic<Key>::value && !std::is_same<Key, bool>::value &&
+        std::is_same<K, Key>::value && has_contiguous_data<Container>::value &&
+        (std::is_same<Compare, std::less<Key>>::value || std::is_same<Compare, std::less<>>::value)
+    >;
+
+    inline void prefetch(const void *p)
+    {
+#if defined(_MSC_VER)
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#elif defined(__GNUC__)
+        __builtin_prefetch(p);
+#else
+        (void)p;
+#endif
+    }
+
+    // Prefetching needs a real address; proxy references (std::vector<bool>) get none.
+    template<class It, typename std::enable_if<std::is_lvalue_reference<typename std::iterator_traits<It>::reference>::value, int>::type = 0>
+    void prefetch_element(const It& it) { flat_search_detail::prefetch(std::addressof(*it)); }
+
+    template<class It, typename std::enable_if<!std::is_lvalue_reference<typename std::iterator_traits<It>::reference>::value, int>::type = 0>
+    void prefetch_element(const It&) {}
+
+    // count_before<Greater>(p, n, x) counts the elements of p[0..n) with
+    // p[i] < x, or with x < p[i] when Greater is true.
+    template<bool Greater, class T>
+    size_t count_scalar(const T *p, size_t n, T x) {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            count += Greater ? size_t(x < p[i]) : size_t(p[i] < x);
+        }
+        return count;
+    }
+
+    template<class T>
+    using simd_kind = std::integral_constant<int,
+        std::is_same<T, float>::value ? 1 :
+        std::is_same<T, double>::value ? 2 :
+        (std::is_integral<T>::value && sizeof(T) == 4) ? 3 : 0
+    >;
+
+    template<bool Greater, class T>
+    size_t count_before(const T *p, size_t n, T x, std::integral_constant<int, 0>) {
+        return flat_search_detail::count_scalar<Greater>(p, n, x);
+    }
+
+#if defined(SG14_FLAT_SEARCH_SSE2)
+    inline size_t horizontal_sum(__m128i v) {
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return static_cast<size_t>(_mm_cvtsi128_si32(v));
+    }
+
+    // Each all-ones lane of a comparison is -1; subtracting accumulates counts.
+    template<bool Greater>
+    size_t count_before(const float *p, size_t n, float x, std::integral_constant<int, 1>) {
+        const __m128 vx = _mm_set1_ps(x);
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(p + i);
+            __m128 m = Greater ? _mm_cmplt_ps(vx, v) : _mm_cmplt_ps(v, vx);
+            acc = _mm_sub_epi32(acc, _mm_castps_si128(m));
+        }
+        return horizontal_sum(acc) + flat_search_detail::count_scalar<Greater>(p + i, n - i, x);
+    }
+
+    template<bool Greater>
+    size_t count_before(const double *p, size_t n, double x, std::integral_constant<int, 2>) {
+        const __m128d vx = _mm_set1_pd(x);
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            __m128d v = _mm_loadu_pd(p + i);
+            __m128d m = Greater ? _mm_cmplt_pd(vx, v) : _mm_cmplt_pd(v, vx);
+            acc = _mm_sub_epi32(acc, _mm_castpd_si128(m));
+        }
+        // Each 64-bit lane holds its count in both 32-bit halves.
+        return horizontal_sum(acc) / 2 + flat_search_detail::count_scalar<Greater>(p + i, n - i, x);
+    }
+
+    template<bool Greater, class T>
+    size_t count_before(const T *p, size_t n, T x, std::integral_constant<int, 3>) {
+        // SSE2 only compares signed lanes; flipping the sign bit of unsigned
+        // values maps their order onto the signed order.
+        const int bias = std::is_signed<T>::value ? 0 : int(0x80000000u);
+        const __m128i vbias = _mm_set1_epi32(bias);
+        const __m128i vx = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(x)), vbias);
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), vbias);
+            __m128i m = Greater ? _mm_cmplt_epi32(vx, v) : _mm_cmplt_epi32(v, vx);
+            acc = _mm_sub_epi32(acc, m);
+        }
+        return horizontal_sum(acc) + flat_search_detail::count_scalar<Greater>(p + i, n - i, x);
+    }
+#else
+    template<bool Greater, class T, int K>
+    size_t count_before(const T *p, size_t n, T x, std::integral_constant<int, K>) {
+        return flat_search_detail::count_scalar<Greater>(p, n, x);
+    }
+#endif
+
+    // Returns the number of elements of the sorted range p[0..n) that are
+    // less than x, or, when Upper is true, not greater than x.
+    // The binary search runs without branches on the comparison and
+    // prefetches both possible next probes; once the remaining range spans
+    // a couple of cache lines, it is finished by a linear SIMD count.
+    template<bool Upper, class T>
+    size_t branchless_bound(const T *p, size_t n, T x) {
+        constexpr size_t linear_size = 2 * SG14_CACHE_LINE_SIZE / sizeof(T);
+        const T *base = p;
+        while (n > linear_size) {
+            size_t half = n / 2;
+            flat_search_detail::prefetch(base + half / 2);
+            flat_search_detail::prefetch(base + half + half / 2);
+            bool before = Upper ? !(x < base[half]) : (base[half] < x);
+            base = before ? base + half : base;
+            n -= half;
+        }
+        size_t offset = static_cast<size_t>(base - p);
+        if (Upper) {
+            return offset + n - flat_search_detail::count_before<true>(base, n, x, simd_kind<T>());
+        } else {
+            return offset + flat_search_detail::count_before<false>(base, n, x, simd_kind<T>());
+        }
+    }
+
+    template<class Container>
+    using key_of = typename std::remove_const<Container>::type::value_type;
+
+    template<class Container, class K, class Compare>
+    auto lower_bound(Container& c, const K& x, Compare& compare, std::false_type) {
+        return std::partition_point(c.begin(), c.end(), [&](const key_of<Container>& elt) {
+            return bool(compare(elt, x));
+        });
+    }
+
+    template<class Container, class K, class Compare>
+    auto lower_bound(Container& c, const K& x, Compare&, std::true_type) {
+        return c.begin() + static_cast<ptrdiff_t>(flat_search_detail::branchless_bound<false>(c.data(), c.size(), x));
+    }
+
+    template<class Container, class K, class Compare>
+    auto upper_bound(Container& c, const K& x, Compare& compare, std::false_type) {
+        return std::partition_point(c.begin(), c.end(), [&](const key_of<Container>& elt) {
+            return !bool(compare(x, elt));
+        });
+    }
+
+    template<class Container, class K, class Compare>
+    auto upper_bound(Container& c, const K& x, Compare&, std::true_type) {
+        return c.begin() + static_cast<ptrdiff_t>(flat_search_detail::branchless_bound<true>(c.data(), c.size(), x));
+    }
+
+    // A key container whose layout a plain binary search would walk badly
+    // may search itself: if c.bound_index(x, compare, std::false_type()) is
+    // well-formed, it returns the index of the first key not less than x,
+    // and with std::true_type the index of the first key greater than x.
+    template<class Container, class K, class Compare, class = void>
+    struct has_bound_index : std::false_type {};
+
+    template<class Container, class K, class Compare>
+    struct has_bound_index<Container, K, Compare, void_t<decltype(
+        std::declval<const Container&>().bound_index(std::declval<const K&>(), std::declval<Compare&>(), std::false_type())
+    )>> : std::true_type {};
+
+    template<class Upper, class Container, class K, class Compare>
+    auto bound(Container& c, const K& x, Compare& compare, Upper upper, std::true_type) {
+        return c.begin() + static_cast<ptrdiff_t>(c.bound_index(x, compare, upper));
+    }
+
+    template<class Container, class K, class Compare>
+    auto bound(Container& c, const K& x, Compare& compare, std::false_type, std::false_type) {
+        using Fast = uses_fast_search<typename std::remove_const<Container>::type, typename std::remove_const<Compare>::type, K>;
+        return flat_search_detail::lower_bound(c, x, compare, Fast());
+    }
+
+    template<class Container, class K, class Compare>
+    auto bound(Container& c, const K& x, Compare& compare, std::true_type, std::false_type) {
+        using Fast = uses_fast_search<typename std::remove_const<Container>::type, typename std::remove_const<Compare>::type, K>;
+        return flat_search_detail::upper_bound(c, x, compare, Fast());
+    }
+
+    // lower_bound(c, x, compare), upper_bound(c, x, compare) and
+    // equal_range(c, x, compare) search the whole sorted container c and
+    // return iterators of c. equal_range relies on the keys being unique.
+    template<class Container, class K, class Compare>
+    auto lower_bound(Container& c, const K& x, Compare& compare) {
+        using Hooked = has_bound_index<typename std::remove_const<Container>::type, K, Compare>;
+        return flat_search_detail::bound(c, x, compare, std::false_type(), Hooked());
+    }
+
+    template<class Container, class K, class Compare>
+    auto upper_bound(Container& c, const K& x, Compare& compare) {
+        using Hooked = has_bound_index<typename std::remove_const<Container>::type, K, Compare>;
+        return flat_search_detail::bound(c, x, compare, std::true_type(), Hooked());
+    }
+
+    template<class Container, class K, class Compare>
+    auto equal_range(Container& c, const K& x, Compare& compare) {
+        auto lo = flat_search_detail::lower_bound(c, x, compare);
+        auto hi = lo;
+        if (lo != c.end()) {
+            const key_of<Container>& elt = *lo;
+            hi += !bool(compare(x, elt));
+        }
+        return std::make_pair(lo, hi);
+    }
+
+    // As equal_range, for a heterogeneous key x, which a transparent
+    // comparator may find equivalent to any number of keys of c.
+    template<class Container, class K, class Compare>
+    auto equal_range_heterogeneous(Container& c, const K& x, Compare& compare) {
+        auto lo = flat_search_detail::lower_bound(c, x, compare);
+        auto hi = std::partition_point(lo, c.end(), [&](const key_of<Container>& elt) {
+            return !bool(compare(x, elt));
+        });
+        return std::make_pair(lo, hi);
+    }
+
+    // Returns the first position at or after from whose key is not less
+    // than x, probing from, from+1, from+3, from+7, ... and then binary
+    // searching the last gap: O(log d) for a result d positions ahead.
+    template<class It, class K, class Compare>
+    It gallop_lower_bound(It from, It last, const K& x, Compare& compare) {
+        if (from == last || !bool(compare(*from, x))) {
+            return from;
+        }
+        // Invariant: *lo < x.
+        It lo = from;
+        ptrdiff_t step = 1;
+        while (step < last - lo && bool(compare(lo[step], x))) {
+            lo += step;
+            step *= 2;
+        }
+        It hi = (step < last - lo) ? lo + step : last;
+        return std::partition_point(lo + 1, hi, [&](const auto& elt) { return bool(compare(elt, x)); });
+    }
+
+    // search_many(c, first, last, compare, emit) calls emit(i, found) for
+    // each probe in [first, last), in order, where i is the lower_bound
+    // position of the probe in the sorted container c.
+    // Probes that arrive in order are galloped from the previous result,
+    // so a sorted batch costs about a merge. An unsorted batch held in a
+    // forward range is instead searched in blocks, advancing the binary
+    // searches of a whole block in lockstep so that their cache misses
+    // overlap, each step prefetching the next probe of each search.
+    template<class Container, class InputIterator, class Compare, class Emit>
+    void search_many_galloping(const Container& c, InputIterator first, InputIterator last, Compare& compare, Emit& emit) {
+        auto kbegin = c.begin();
+        auto kend = c.end();
+        auto pos = kbegin;
+        for (; first != last; ++first) {
+            const auto& x = *first;
+            if (pos != kbegin && bool(compare(x, pos[-1]))) {
+                pos = kbegin;  // out of order; start over
+            }
+            pos = flat_search_detail::gallop_lower_bound(pos, kend, x, compare);
+            emit(static_cast<size_t>(pos - kbegin), pos != kend && !bool(compare(x, *pos)));
+        }
+    }
+
+    template<class Container, class ForwardIterator, class Compare, class Emit>
+    void search_many_interleaved(const Container& c, ForwardIterator first, ForwardIterator last, Compare& compare, Emit& emit) {
+        constexpr size_t block_size = 16;
+        auto kbegin = c.begin();
+        const size_t size = c.size();
+        ForwardIterator probes[block_size];
+        size_t base[block_size];
+        while (first != last) {
+            size_t count = 0;
+            for (; count < block_size && first != last; ++count, ++first) {
+                probes[count] = first;
+                base[count] = 0;
+            }
+            size_t n = size;
+            while (n > 1) {
+                size_t half = n / 2;
+                n -= half;
+                for (size_t b = 0; b < count; ++b) {
+                    bool before = bool(compare(kbegin[static_cast<ptrdiff_t>(base[b] + half)], *probes[b]));
+                    base[b] = before ? base[b] + half : base[b];
+                    flat_search_detail::prefetch_element(kbegin + static_cast<ptrdiff_t>(base[b] + n / 2));
+                }
+            }
+            for (size_t b = 0; b < count; ++b) {
+                size_t i = base[b];
+                if (size != 0 && bool(compare(kbegin[static_cast<ptrdiff_t>(i)], *probes[b]))) {
+                    ++i;
+                }
+                emit(i, i != size && !bool(compare(*probes[b], kbegin[static_cast<ptrdiff_t>(i)])));
+            }
+        }
+    }
+
+    template<class Container, class InputIterator, class Compare, class Emit>
+    void search_many(const Container& c, InputIterator first, InputIterator last, Compare& compare, Emit emit, std::input_iterator_tag) {
+        flat_search_detail::search_many_galloping(c, first, last, compare, emit);
+    }
+
+    template<class Container, class ForwardIterator, class Compare, class Emit>
+    void search_many(const Container& c, ForwardIterator first, ForwardIterator last, Compare& compare, Emit emit, std::forward_iterator_tag) {
+        if (std::is_sorted(first, last, [&](const auto& a, const auto& b) { return bool(compare(a, b)); })) {
+            flat_search_detail::search_many_galloping(c, first, last, compare, emit);
+        } else {
+            flat_search_detail::search_many_interleaved(c, first, last, compare, emit);
+        }
+    }
+
+    template<class Container, class InputIterator, class Compare, class Emit>
+    void search_many(const Container& c, InputIterator first, InputIterator last, Compare& compare, Emit emit) {
+        flat_search_detail::search_many(c, first, last, compare, emit, typename std::iterator_traits<InputIterator>::iterator_category());
+    }
+
+    template<class Container, class Compare, class Key = typename Container::value_type>
+    using uses_simd_set_ops = std::integral_constant<bool,
+        std::is_integral<Key>::value && !std::is_same<Key, bool>::value &&
+        (sizeof(Key) == 4 || sizeof(Key) == 8) && has_contiguous_data<Container>::value &&
+        (std::is_same<Compare, std::less<Key>>::value || std::is_same<Compare, std::less<>>::value)
+    >;
+
+    // Finishes filter_sorted one element at a time. Bit k of matched is set
+    // if a[i+k] is already known to be in b.
+    template<bool Keep, class T>
+    size_t filter_sorted_tail(const T *a, size_t i, size_t na, const T *b, size_t j, size_t nb, T *out, size_t w, unsigned matched) {
+        for (size_t k = 0; i < na; ++i, ++k) {
+            bool found = (k < 8) && ((matched >> k) & 1u);
+            if (!found) {
+                while (j < nb && b[j] < a[i]) ++j;
+                found = (j < nb && b[j] == a[i]);
+            }
+            if (found == Keep) {
+                out[w++] = a[i];
+            }
+        }
+        return w;
+    }
+
+    template<bool Keep, class T, size_t Size>
+    size_t filter_sorted(const T *a, size_t na, const T *b, size_t nb, T *out, std::integral_constant<size_t, Size>) {
+        return flat_search_detail::filter_sorted_tail<Keep>(a, 0, na, b, 0, nb, out, 0, 0);
+    }
+
+#if defined(SG14_FLAT_SEARCH_SSE2)
+    // Compares a block of a against every rotation of a block of b at once,
+    // and accumulates which elements of the a-block were seen, until the
+    // a-block is passed. Only the block maxima take a scalar comparison.
+    template<bool Keep, class T>
+    size_t filter_sorted(const T *a, size_t na, const T *b, size_t nb, T *out, std::integral_constant<size_t, 4>) {
+        size_t i = 0, j = 0, w = 0;
+        unsigned matched = 0;
+        while (i + 4 <= na && j + 4 <= nb) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            __m128i m = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))))
+            );
+            matched |= static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(m)));
+            T amax = a[i + 3];
+            T bmax = b[j + 3];
+            if (!(bmax < amax)) {
+                for (size_t k = 0; k < 4; ++k) {
+                    if (bool((matched >> k) & 1u) == Keep) {
+                        out[w++] = a[i + k];
+                    }
+                }
+                i += 4;
+                matched = 0;
+            }
+            if (!(amax < bmax)) {
+                j += 4;
+            }
+        }
+        return flat_search_detail::filter_sorted_tail<Keep>(a, i, na, b, j, nb, out, w, matched);
+    }
+
+    inline __m128i cmpeq_epi64(__m128i x, __m128i y) {
+        __m128i t = _mm_cmpeq_epi32(x, y);
+        return _mm_and_si128(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+
+    template<bool Keep, class T>
+    size_t filter_sorted(const T *a, size_t na, const T *b, size_t nb, T *out, std::integral_constant<size_t, 8>) {
+        size_t i = 0, j = 0, w = 0;
+        unsigned matched = 0;
+        while (i + 2 <= na && j + 2 <= nb) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            __m128i m = _mm_or_si128(cmpeq_epi64(va, vb), cmpeq_epi64(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+            matched |= static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(m)));
+            T amax = a[i + 1];
+            T bmax = b[j + 1];
+            if (!(bmax < amax)) {
+                for (size_t k = 0; k < 2; ++k) {
+                    if (bool((matched >> k) & 1u) == Keep) {
+                        out[w++] = a[i + k];
+                    }
+                }
+                i += 2;
+                matched = 0;
+            }
+            if (!(amax < bmax)) {
+                j += 2;
+            }
+        }
+        return flat_search_detail::filter_sorted_tail<Keep>(a, i, na, b, j, nb, out, w, matched);
+    }
+#endif
+
+    // Writes to out the elements of the sorted unique a[0..na) that are
+    // (Keep) or are not (!Keep) in the sorted unique b[0..nb): their
+    // intersection or difference. Returns the number written. out may be a,
+    // for filtering in place.
+    template<bool Keep, class T>
+    size_t filter_sorted(const T *a, size_t na, const T *b, size_t nb, T *out) {
+        return flat_search_detail::filter_sorted<Keep>(a, na, b, nb, out, std::integral_constant<size_t, sizeof(T)>());
+    }
+
+    // In the Eytzinger layout, node k (counting from 1) has children 2k and
+    // 2k+1 and is stored at position k-1; 0 stands for "no node".
+    inline size_t eytzinger_first(size_t n) {
+        size_t k = (n != 0) ? 1 : 0;
+        while (k != 0 && 2 * k <= n) k = 2 * k;
+        return k;
+    }
+
+    inline size_t eytzinger_last(size_t n) {
+        size_t k = (n != 0) ? 1 : 0;
+        while (k != 0 && 2 * k + 1 <= n) k = 2 * k + 1;
+        return k;
+    }
+
+    // The in-order successor of node k, or 0 after the last node.
+    inline size_t eytzinger_next(size_t k, size_t n) {
+        if (2 * k + 1 <= n) {
+            k = 2 * k + 1;
+            while (2 * k <= n) k = 2 * k;
+            return k;
+        }
+        while (k & 1) k >>= 1;
+        return k >> 1;
+    }
+
+    // The in-order predecessor of node k; from 0, the last node.
+    inline size_t eytzinger_prev(size_t k, size_t n) {
+        if (k == 0) {
+            return eytzinger_last(n);
+        }
+        if (2 * k <= n) {
+            k = 2 * k;
+            while (2 * k + 1 <= n) k = 2 * k + 1;
+            return k;
+        }
+        while (k != 0 && !(k & 1)) k >>= 1;
+        return k >> 1;
+    }
+
+    inline unsigned trailing_ones(size_t k) {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_ctzll(~static_cast<unsigned long long>(k)));
+#else
+        unsigned count = 0;
+        while (k & 1) { k >>= 1; ++count; }
+        return count;
+#endif
+    }
+
+    // eytzinger_order(n)[i] is the sorted position of the element stored
+    // at position i of the Eytzinger layout; sorted_order(n) is its inverse.
+    inline std::vector<size_t> eytzinger_order(size_t n) {
+        std::vector<size_t> from(n);
+        size_t rank = 0;
+        for (size_t k = eytzinger_first(n); k != 0; k = eytzinger_next(k, n)) {
+            from[k - 1] = rank++;
+        }
+        return from;
+    }
+
+    inline std::vector<size_t> sorted_order(size_t n) {
+        std::vector<size_t> from(n);
+        size_t rank = 0;
+        for (size_t k = eytzinger_first(n); k != 0; k = eytzinger_next(k, n)) {
+            from[rank++] = k - 1;
+        }
+        return from;
+    }
+
+    // Moves c[from[i]] to c[i] for every i, moving each element once along
+    // the cycles of the permutation. Consumes from.
+    template<class Container>
+    void permute(Container& c, std::vector<size_t>& from) {
+        auto first = c.begin();
+        for (size_t start = 0; start < from.size(); ++start) {
+            if (from[start] == start) continue;
+            auto tmp = std::move(first[start]);
+            size_t cur = start;
+            while (from[cur] != start) {
+                size_t src = from[cur];
+                first[cur] = std::move(first[src]);
+                from[cur] = cur;
+                cur = src;
+            }
+            first[cur] = std::move(tmp);
+            from[cur] = cur;
+        }
+    }
+
+    // Returns the first node k, in order, whose element e has !before(e),
+    // or 0 if there is none. Each step fetches the descendants a few
+    // levels down, which share a cache line in the Eytzinger layout.
+    template<class It, class Pred>
+    size_t eytzinger_search(It first, size_t n, Pred before) {
+        using T = typename std::iterator_traits<It>::value_type;
+        constexpr size_t per_line = (sizeof(T) >= SG14_CACHE_LINE_SIZE) ? 1 : SG14_CACHE_LINE_SIZE / sizeof(T);
+        constexpr size_t lookahead = (per_line >= 16) ? 16 : (per_line >= 8) ? 8 : (per_line >= 4) ? 4 : (per_line >= 2) ? 2 : 1;
+        size_t k = 1;
+        while (k <= n) {
+            if (lookahead * k <= n) {
+                flat_search_detail::prefetch_element(first + static_cast<ptrdiff_t>(lookahead * k - 1));
+            }
+            k = 2 * k + size_t(bool(before(first[static_cast<ptrdiff_t>(k - 1)])));
+        }
+        return k >> (trailing_ones(k) + 1);
+    }
+
+} // namespace flat_search_detail
+
+} // namespace stdext
@@ -29,6 +29,8 @@
 // This is an implementation of the proposed "std::flat_set" as specified in
 // http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2019/p1222r1.pdf
 
+#include "flat_search.h"
+
 #include <stddef.h>
 #include <algorithm>
 #include <functional>
@@ -480,8 +482,18 @@ public:
         return 0;
     }
 
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent,
+             class = typename std::enable_if<!std::is_convertible<const K&, iterator>::value && !std::is_convertible<const K&, const_iterator>::value>::type>
+    size_type erase(const K& x) {
+        auto its = this->equal_range(x);
+        size_type n = static_cast<size_type>(its.second - its.first);
+        this->erase(its.first, its.second);
+        return n;
+    }
+
     iterator erase(const_iterator first, const_iterator last) {
-        c_.erase(first, last);
+        return c_.erase(first, last);
     }
 
     void swap(flat_set& m) noexcept
@@ -544,7 +556,8 @@ public:
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     size_type count(const K& x) const {
-        return this->contains(x) ? 1 : 0;
+        auto its = this->equal_range(x);
+        return static_cast<size_type>(its.second - its.first);
     }
 
     bool contains(const Key& x) const {
@@ -558,103 +571,63 @@ public:
     }
 
     iterator lower_bound(const Key& t) {
-        return std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return bool(compare_(elt, t));
-        });
+        return flat_search_detail::lower_bound(c_, t, compare_);
     }
 
     const_iterator lower_bound(const Key& t) const {
-        return std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return bool(compare_(elt, t));
-        });
+        return flat_search_detail::lower_bound(c_, t, compare_);
     }
 
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     iterator lower_bound(const K& x) {
-        return std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return bool(compare_(elt, x));
-        });
+        return flat_search_detail::lower_bound(c_, x, compare_);
     }
 
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     const_iterator lower_bound(const K& x) const {
-        return std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return bool(compare_(elt, x));
-        });
+        return flat_search_detail::lower_bound(c_, x, compare_);
     }
 
     iterator upper_bound(const Key& t) {
-        return std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return !bool(compare_(t, elt));
-        });
+        return flat_search_detail::upper_bound(c_, t, compare_);
     }
 
     const_iterator upper_bound(const Key& t) const {
-        return std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return !bool(compare_(t, elt));
-        });
+        return flat_search_detail::upper_bound(c_, t, compare_);
     }
 
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     iterator upper_bound(const K& x) {
-        return std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return !bool(compare_(x, elt));
-        });
+        return flat_search_detail::upper_bound(c_, x, compare_);
     }
 
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     const_iterator upper_bound(const K& x) const {
-        return std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return !bool(compare_(x, elt));
-        });
+        return flat_search_detail::upper_bound(c_, x, compare_);
     }
 
     std::pair<iterator, iterator> equal_range(const Key& t) {
-        auto lo = std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return bool(compare_(elt, t));
-        });
-        auto hi = std::partition_point(lo, this->end(), [&](const Key& elt) {
-            return !bool(compare_(t, elt));
-        });
-        return { lo, hi };
+        return flat_search_detail::equal_range(c_, t, compare_);
     }
 
     std::pair<const_iterator, const_iterator> equal_range(const Key& t) const {
-        auto lo = std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return bool(compare_(elt, t));
-        });
-        auto hi = std::partition_point(lo, this->end(), [&](const Key& elt) {
-            return !bool(compare_(t, elt));
-        });
-        return { lo, hi };
+        return flat_search_detail::equal_range(c_, t, compare_);
     }
 
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     std::pair<iterator, iterator> equal_range(const K& x) {
-        auto lo = std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return bool(compare_(elt, x));
-        });
-        auto hi = std::partition_point(lo, this->end(), [&](const Key& elt) {
-            return !bool(compare_(x, elt));
-        });
-        return { lo, hi };
+        return flat_search_detail::equal_range_heterogeneous(c_, x, compare_);
     }
 
     template<class K,
              class Compare_ = Compare, class = typename Compare_::is_transparent>
     std::pair<const_iterator, const_iterator> equal_range(const K& x) const {
-        auto lo = std::partition_point(this->begin(), this->end(), [&](const Key& elt) {
-            return bool(compare_(elt, x));
-        });
-        auto hi = std::partition_point(lo, this->end(), [&](const Key& elt) {
-            return !bool(compare_(x, elt));
-        });
-        return { lo, hi };
+        return flat_search_detail::equal_range_heterogeneous(c_, x, compare_);
     }
 
 private:
@@ -711,6 +684,223 @@ void swap(flat_set<Key, Compare, KeyContainer>& x, flat_set<Key, Compare, KeyCon
     return x.swap(y);
 }
 
+namespace flatset_detail {
+
+    template<class FS>
+    using simd_set_ops = flat_search_detail::uses_simd_set_ops<typename FS::container_type, typename FS::key_compare>;
+
+    template<class FS>
+    const typename FS::key_type *data_of(const FS& fs) {
+        return fs.empty() ? nullptr : std::addressof(*fs.begin());
+    }
+
+    // Replaces the contents of c, reusing its capacity, with the keys of
+    // a that are (Keep) or are not (!Keep) in b.
+    template<bool Keep, class FS, class Container>
+    void filter_into(const FS& a, const FS& b, Container& c, std::true_type) {
+        c.resize(a.size());
+        c.resize(flat_search_detail::filter_sorted<Keep>(data_of(a), a.size(), data_of(b), b.size(), c.data()));
+    }
+
+    template<bool Keep, class FS, class Container, typename std::enable_if<Keep, int>::type = 0>
+    void filter_into_generic(const FS& a, const FS& b, Container& c) {
+        c.clear();
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(c), a.key_comp());
+    }
+
+    template<bool Keep, class FS, class Container, typename std::enable_if<!Keep, int>::type = 0>
+    void filter_into_generic(const FS& a, const FS& b, Container& c) {
+        c.clear();
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(c), a.key_comp());
+    }
+
+    template<bool Keep, class FS, class Container>
+    void filter_into(const FS& a, const FS& b, Container& c, std::false_type) {
+        flatset_detail::filter_into_generic<Keep>(a, b, c);
+    }
+
+    // Filters the keys of c, which are sorted and unique, in place.
+    template<bool Keep, class FS, class Container>
+    void filter_in_place(Container& c, const FS& b, std::true_type) {
+        const typename FS::key_type *first = c.empty() ? nullptr : c.data();
+        c.resize(flat_search_detail::filter_sorted<Keep>(first, c.size(), data_of(b), b.size(), c.data()));
+    }
+
+    template<bool Keep, class FS, class Container>
+    void filter_in_place(Container& c, const FS& b, std::false_type) {
+        auto compare = b.key_comp();
+        auto bit = b.begin();
+        auto w = c.begin();
+        for (auto r = c.begin(); r != c.end(); ++r) {
+            while (bit != b.end() && bool(compare(*bit, *r))) ++bit;
+            bool found = (bit != b.end() && !bool(compare(*r, *bit)));
+            if (found == Keep) {
+                if (w != r) {
+                    *w = std::move(*r);
+                }
+                ++w;
+            }
+        }
+        c.erase(w, c.end());
+    }
+
+    // Merges b into c, which is sorted and unique, from the back; no key
+    // of c moves more than once and nothing is allocated if c has room.
+    template<class FS, class Container, typename std::enable_if<std::is_default_constructible<typename FS::key_type>::value, int>::type = 0>
+    void union_in_place(Container& c, const FS& b) {
+        auto compare = b.key_comp();
+        size_t na = c.size();
+        size_t nb = b.size();
+        size_t common = 0;
+        auto ait = c.begin();
+        for (auto bit = b.begin(); bit != b.end(); ++bit) {
+            while (ait != c.end() && bool(compare(*ait, *bit))) ++ait;
+            common += (ait != c.end() && !bool(compare(*bit, *ait)));
+        }
+        if (common == nb) {
+            return;
+        }
+        c.resize(na + nb - common);
+        auto cf = c.begin();
+        auto bf = b.begin();
+        size_t i = na, j = nb, w = c.size();
+        while (j != 0) {
+            if (i != 0 && !bool(compare(cf[i-1], bf[j-1]))) {
+                // The key in c is not smaller; on a tie, c's key is kept.
+                j -= !bool(compare(bf[j-1], cf[i-1]));
+                if (--w != --i) {
+                    cf[w] = std::move(cf[i]);
+                }
+            } else {
+                cf[--w] = bf[--j];
+            }
+        }
+    }
+
+    template<class FS, class Container, typename std::enable_if<!std::is_default_constructible<typename FS::key_type>::value, int>::type = 0>
+    void union_in_place(Container& c, const FS& b) {
+        Container result;
+        std::set_union(std::make_move_iterator(c.begin()), std::make_move_iterator(c.end()), b.begin(), b.end(), std::back_inserter(result), b.key_comp());
+        c = std::move(result);
+    }
+
+} // namespace flatset_detail
+
+// Set algebra on flat_sets ordered by the same comparator. Each operation
+// returns a new flat_set, or writes into dest, replacing its contents and
+// reusing the capacity of its container. dest may also be one of the
+// operands: intersection and difference then filter dest in place, and
+// union merges the other operand into it from the back.
+// Sets of 32- and 64-bit integers ordered by std::less intersect and
+// subtract with SIMD block comparisons.
+template<class Key, class Compare, class KeyContainer>
+void set_intersection(const flat_set<Key, Compare, KeyContainer>& a, const flat_set<Key, Compare, KeyContainer>& b, flat_set<Key, Compare, KeyContainer>& dest)
+{
+    using Fast = flatset_detail::simd_set_ops<flat_set<Key, Compare, KeyContainer>>;
+    if (&dest == &b && &dest != &a) {
+        return stdext::set_intersection(b, a, dest);
+    }
+    if (&dest == &a) {
+        if (&a != &b) {
+            KeyContainer c = std::move(dest).extract();
+            flatset_detail::filter_in_place<true>(c, b, Fast());
+            dest.replace(std::move(c));
+        }
+    } else {
+        KeyContainer c = std::move(dest).extract();
+        flatset_detail::filter_into<true>(a, b, c, Fast());
+        dest.replace(std::move(c));
+    }
+}
+
+template<class Key, class Compare, class KeyContainer>
+void set_difference(const flat_set<Key, Compare, KeyContainer>& a, const flat_set<Key, Compare, KeyContainer>& b, flat_set<Key, Compare, KeyContainer>& dest)
+{
+    using Fast = flatset_detail::simd_set_ops<flat_set<Key, Compare, KeyContainer>>;
+    if (&a == &b) {
+        dest.clear();
+    } else if (&dest == &a) {
+        KeyContainer c = std::move(dest).extract();
+        flatset_detail::filter_in_place<false>(c, b, Fast());
+        dest.replace(std::move(c));
+    } else if (&dest == &b) {
+        flat_set<Key, Compare, KeyContainer> result(a.key_comp());
+        stdext::set_difference(a, b, result);
+        dest = std::move(result);
+    } else {
+        KeyContainer c = std::move(dest).extract();
+        flatset_detail::filter_into<false>(a, b, c, Fast());
+        dest.replace(std::move(c));
+    }
+}
+
+template<class Key, class Compare, class KeyContainer>
+void set_union(const flat_set<Key, Compare, KeyContainer>& a, const flat_set<Key, Compare, KeyContainer>& b, flat_set<Key, Compare, KeyContainer>& dest)
+{
+    if (&dest == &b && &dest != &a) {
+        return stdext::set_union(b, a, dest);
+    }
+    if (&dest == &a) {
+        if (&a != &b) {
+            KeyContainer c = std::move(dest).extract();
+            flatset_detail::union_in_place(c, b);
+            dest.replace(std::move(c));
+        }
+    } else {
+        KeyContainer c = std::move(dest).extract();
+        c.clear();
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(c), a.key_comp());
+        dest.replace(std::move(c));
+    }
+}
+
+template<class Key, class Compare, class KeyContainer>
+void set_symmetric_difference(const flat_set<Key, Compare, KeyContainer>& a, const flat_set<Key, Compare, KeyContainer>& b, flat_set<Key, Compare, KeyContainer>& dest)
+{
+    if (&dest == &a || &dest == &b) {
+        flat_set<Key, Compare, KeyContainer> result(a.key_comp());
+        stdext::set_symmetric_difference(a, b, result);
+        dest = std::move(result);
+    } else {
+        KeyContainer c = std::move(dest).extract();
+        c.clear();
+        std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(c), a.key_comp());
+        dest.replace(std::move(c));
+    }
+}
+
+template<class Key, class Compare, class KeyContainer>
+flat_set<Key, Compare, KeyContainer> set_intersection(const flat_set<Key, Compare, KeyContainer>& a, const flat_set<Key, Compare, KeyContainer>& b)
+{
+    flat_set<Key, Compare, KeyContainer> result(a.key_comp());
+    stdext::set_intersection(a, b, result);
+    return result;
+}
+
+template<class Key, class Compare, class KeyContainer>
+flat_set<Key, Compare, KeyContainer> set_difference(const flat_set<Key, Compare, KeyContainer>& a, const flat_set<Key, Compare, KeyContainer>& b)
+{
+    flat_set<Key, Compare, KeyContainer> result(a.key_comp());
+    stdext::set_difference(a, b, result);
+    return result;
+}
+
+template<class Key, class Compare, class KeyContainer>
+flat_set<Key, Compare, KeyContainer> set_union(const flat_set<Key, Compare, KeyContainer>& a, const flat_set<Key, Compare, KeyContainer>& b)
+{
+    flat_set<Key, Compare, KeyContainer> result(a.key_comp());
+    stdext::set_union(a, b, result);
+    return result;
+}
+
+template<class Key, class Compare, class KeyContainer>
+flat_set<Key, Compare, KeyContainer> set_symmetric_difference(const flat_set<Key, Compare, KeyContainer>& a, const flat_set<Key, Compare, KeyContainer>& b)
+{
+    flat_set<Key, Compare, KeyContainer> result(a.key_comp());
+    stdext::set_symmetric_difference(a, b, result);
+    return result;
+}
+
 #if defined(__cpp_deduction_guides)
 
 // TODO: this deduction guide should maybe be constrained by qualifies_as_range
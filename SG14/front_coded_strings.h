@@ -0,0 +1,612 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+// front_coded_strings is a sequence container of std::string meant to be
+// the KeyContainer of a flat_map or flat_set with many sorted string keys:
+//
+//     stdext::flat_map<std::string, V, std::less<>, stdext::front_coded_strings<>>
+//
+// The keys live in one byte arena, in blocks of BlockSize. The first key of
+// a block is stored whole; every other key is stored as the length of the
+// prefix it shares with the previous key plus the rest of its bytes. An
+// array holding the first 8 bytes of each block's first key, big-endian,
+// decides most steps of a search by integer comparison, so a lookup under
+// std::less<std::string> or std::less<> reads that array, then one block,
+// and never materializes a key.
+//
+// Elements are read by value: dereferencing a const_iterator decodes a
+// std::string, and a mutable iterator yields a proxy that re-encodes the
+// element's block when assigned to. Appending and erasing at the end are
+// cheap; inserting or erasing elsewhere re-encodes everything after the
+// position, as a vector would move it.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __has_include(<string_view>)
+#include <string_view>
+#endif
+
+namespace stdext {
+
+namespace front_coded_detail {
+
+    inline void put_varint(std::string& out, size_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    inline size_t get_varint(const char *& p) {
+        size_t v = 0;
+        for (int shift = 0; ; shift += 7) {
+            unsigned char b = static_cast<unsigned char>(*p++);
+            v |= static_cast<size_t>(b & 0x7f) << shift;
+            if (b < 0x80) {
+                return v;
+            }
+        }
+    }
+
+    inline size_t common_prefix(const char *a, size_t na, const char *b, size_t nb) {
+        size_t n = std::min(na, nb);
+        size_t i = 0;
+        while (i < n && a[i] == b[i]) ++i;
+        return i;
+    }
+
+    // Compares as std::string::compare does: bytes as unsigned char.
+    inline int compare_bytes(const char *a, size_t na, const char *b, size_t nb) {
+        size_t n = std::min(na, nb);
+        int c = (n == 0) ? 0 : memcmp(a, b, n);
+        if (c != 0) {
+            return c;
+        }
+        return (na < nb) ? -1 : (na > nb);
+    }
+
+    // The first 8 bytes, big-endian and zero-padded. If prefix_of(a) is less
+    // than prefix_of(b) then a < b; if they are equal, nothing is known.
+    inline uint64_t prefix_of(const char *s, size_t n) {
+        uint64_t r = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            r = (r << 8) | (i < n ? static_cast<unsigned char>(s[i]) : 0u);
+        }
+        return r;
+    }
+
+    struct bytes {
+        const char *data;
+        size_t size;
+    };
+
+    inline bytes bytes_of(const std::string& s) { return bytes{s.data(), s.size()}; }
+    inline bytes bytes_of(const char *s) { return bytes{s, strlen(s)}; }
+#if defined(__cpp_lib_string_view)
+    inline bytes bytes_of(std::string_view s) { return bytes{s.data(), s.size()}; }
+#endif
+
+    // Keys that std::less<> orders exactly as std::string does.
+    template<class K, class T = typename std::decay<K>::type>
+    using is_byte_string = std::integral_constant<bool,
+        std::is_same<T, std::string>::value || std::is_same<T, const char*>::value || std::is_same<T, char*>::value
+#if defined(__cpp_lib_string_view)
+        || std::is_same<T, std::string_view>::value
+#endif
+    >;
+
+    template<class Compare, class C = typename std::remove_const<Compare>::type>
+    using is_lexicographic = std::integral_constant<bool,
+        std::is_same<C, std::less<std::string>>::value || std::is_same<C, std::less<>>::value
+    >;
+
+} // namespace front_coded_detail
+
+template<size_t BlockSize = 16>
+class front_coded_strings {
+    static_assert(BlockSize >= 1, "");
+
+    template<bool Const> class iter;
+public:
+    class reference;
+    using value_type = std::string;
+    using const_reference = std::string;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using iterator = iter<false>;
+    using const_iterator = iter<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    class reference {
+    public:
+        reference(const reference&) = default;
+
+        operator std::string() const { return c_->get(i_); }
+
+        reference& operator=(const std::string& s) {
+            c_->set(i_, s);
+            return *this;
+        }
+
+        reference& operator=(const reference& r) {
+            return *this = static_cast<std::string>(r);
+        }
+
+        friend void swap(reference a, reference b) {
+            std::string t = a;
+            a = static_cast<std::string>(b);
+            b = t;
+        }
+
+        // So that std::less<> can compare proxies with each other and with keys.
+        friend bool operator==(const reference& a, const reference& b) { return std::string(a) == std::string(b); }
+        friend bool operator!=(const reference& a, const reference& b) { return std::string(a) != std::string(b); }
+        friend bool operator<(const reference& a, const reference& b) { return std::string(a) < std::string(b); }
+        friend bool operator>(const reference& a, const reference& b) { return std::string(a) > std::string(b); }
+        friend bool operator==(const reference& a, const std::string& b) { return std::string(a) == b; }
+        friend bool operator!=(const reference& a, const std::string& b) { return std::string(a) != b; }
+        friend bool operator<(const reference& a, const std::string& b) { return std::string(a) < b; }
+        friend bool operator>(const reference& a, const std::string& b) { return std::string(a) > b; }
+        friend bool operator==(const std::string& a, const reference& b) { return a == std::string(b); }
+        friend bool operator!=(const std::string& a, const reference& b) { return a != std::string(b); }
+        friend bool operator<(const std::string& a, const reference& b) { return a < std::string(b); }
+        friend bool operator>(const std::string& a, const reference& b) { return a > std::string(b); }
+
+    private:
+        friend class front_coded_strings;
+        explicit reference(front_coded_strings *c, size_t i) : c_(c), i_(i) {}
+
+        front_coded_strings *c_;
+        size_t i_;
+    };
+
+    front_coded_strings() = default;
+
+    template<class InputIterator,
+             class = typename std::enable_if<!std::is_integral<InputIterator>::value>::type>
+    front_coded_strings(InputIterator first, InputIterator last) {
+        std::vector<std::string> block;
+        block.reserve(BlockSize);
+        for (; first != last; ++first) {
+            block.emplace_back(*first);
+            if (block.size() == BlockSize) {
+                this->append_block(block.data(), block.size());
+                block.clear();
+            }
+        }
+        this->append_block(block.data(), block.size());
+    }
+
+    front_coded_strings(std::initializer_list<std::string> il) : front_coded_strings(il.begin(), il.end()) {}
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, size_); }
+    const_iterator end() const noexcept { return const_iterator(this, size_); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type max_size() const noexcept { return arena_.max_size(); }
+
+    // Bytes held by the arena and the per-block arrays.
+    size_type memory_usage() const noexcept {
+        return arena_.capacity() + offsets_.capacity() * sizeof(size_t) + prefixes_.capacity() * sizeof(uint64_t);
+    }
+
+    reference operator[](size_type i) { return reference(this, i); }
+    std::string operator[](size_type i) const { return get(i); }
+    reference front() { return reference(this, 0); }
+    std::string front() const { return get(0); }
+    reference back() { return reference(this, size_ - 1); }
+    std::string back() const { return get(size_ - 1); }
+
+    void push_back(const std::string& s) {
+        if (size_ % BlockSize == 0) {
+            this->append_block(&s, 1);
+            return;
+        }
+        size_t b = offsets_.size() - 1;
+        size_t extent = block_extent(b);
+        std::string prev = get(size_ - 1);
+        std::string tail;
+        size_t shared = front_coded_detail::common_prefix(prev.data(), prev.size(), s.data(), s.size());
+        front_coded_detail::put_varint(tail, shared);
+        front_coded_detail::put_varint(tail, s.size() - shared);
+        tail.append(s, shared, std::string::npos);
+        if (offsets_[b] + extent != arena_.size()) {
+            // The last block was rewritten elsewhere or truncated: move it
+            // to the end of the arena, where it can grow.
+            std::string moved(arena_.data() + offsets_[b], extent);
+            moved += tail;
+            arena_.append(moved);
+            offsets_[b] = arena_.size() - moved.size();
+            garbage_ += extent;
+        } else {
+            arena_.append(tail);
+        }
+        ++size_;
+    }
+
+    template<class... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        return this->insert(pos, std::string(static_cast<Args&&>(args)...));
+    }
+
+    iterator insert(const_iterator pos, const std::string& s) {
+        size_t i = pos.i_;
+        if (i == size_) {
+            this->push_back(s);
+        } else {
+            this->rebuild_from(i, [&](std::vector<std::string>& tail, size_t k) {
+                tail.insert(tail.begin() + static_cast<ptrdiff_t>(k), s);
+            });
+        }
+        return iterator(this, i);
+    }
+
+    iterator erase(const_iterator pos) {
+        return this->erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        size_t i = first.i_;
+        size_t j = last.i_;
+        if (j == size_) {
+            this->truncate(i);
+        } else if (i != j) {
+            this->rebuild_from(i, [&](std::vector<std::string>& tail, size_t k) {
+                tail.erase(tail.begin() + static_cast<ptrdiff_t>(k), tail.begin() + static_cast<ptrdiff_t>(k + (j - i)));
+            });
+        }
+        return iterator(this, i);
+    }
+
+    void pop_back() {
+        this->truncate(size_ - 1);
+    }
+
+    void clear() noexcept {
+        arena_.clear();
+        offsets_.clear();
+        prefixes_.clear();
+        size_ = 0;
+        garbage_ = 0;
+    }
+
+    void swap(front_coded_strings& other) noexcept {
+        arena_.swap(other.arena_);
+        offsets_.swap(other.offsets_);
+        prefixes_.swap(other.prefixes_);
+        std::swap(size_, other.size_);
+        std::swap(garbage_, other.garbage_);
+    }
+
+    friend void swap(front_coded_strings& a, front_coded_strings& b) noexcept { a.swap(b); }
+
+    friend bool operator==(const front_coded_strings& a, const front_coded_strings& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    friend bool operator!=(const front_coded_strings& a, const front_coded_strings& b) {
+        return !(a == b);
+    }
+
+    // The search hook used by flat_map and flat_set (see flat_search.h):
+    // the index of the first key not less than x, or, if Upper, of the
+    // first key greater than x. Only for lexicographic comparators, and
+    // only valid while the keys are sorted.
+    template<class K, class Compare, bool Upper,
+             class = typename std::enable_if<front_coded_detail::is_lexicographic<Compare>::value && front_coded_detail::is_byte_string<K>::value>::type>
+    size_type bound_index(const K& key, Compare&, std::integral_constant<bool, Upper>) const {
+        using namespace front_coded_detail;
+        const bytes x = bytes_of(key);
+
+        // Count the blocks whose first key precedes x: most are settled by
+        // their prefixes, and only equal prefixes need the whole key.
+        uint64_t xp = prefix_of(x.data, x.size);
+        size_t lo = static_cast<size_t>(std::lower_bound(prefixes_.begin(), prefixes_.end(), xp) - prefixes_.begin());
+        size_t hi = static_cast<size_t>(std::upper_bound(prefixes_.begin() + static_cast<ptrdiff_t>(lo), prefixes_.end(), xp) - prefixes_.begin());
+        while (lo != hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            const char *p = arena_.data() + offsets_[mid];
+            size_t n = get_varint(p);
+            int c = compare_bytes(p, n, x.data, x.size);
+            if (Upper ? (c <= 0) : (c < 0)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == 0) {
+            return 0;
+        }
+
+        // Scan that block, tracking how much of x the previous key matched.
+        // A key sharing less than that with its predecessor has a greater
+        // byte where x has the predecessor's, so it is past x; one sharing
+        // more still precedes x.
+        size_t b = lo - 1;
+        const char *p = arena_.data() + offsets_[b];
+        size_t n = get_varint(p);
+        size_t matched = common_prefix(p, n, x.data, x.size);
+        p += n;
+        size_t count = block_size(b);
+        for (size_t k = 1; k < count; ++k) {
+            size_t shared = get_varint(p);
+            size_t len = get_varint(p);
+            const char *suffix = p;
+            p += len;
+            if (shared < matched) {
+                return b * BlockSize + k;
+            } else if (shared == matched) {
+                int c = compare_bytes(suffix, len, x.data + matched, x.size - matched);
+                if (Upper ? (c > 0) : (c >= 0)) {
+                    return b * BlockSize + k;
+                }
+                matched += common_prefix(suffix, len, x.data + matched, x.size - matched);
+            }
+        }
+        return b * BlockSize + count;
+    }
+
+private:
+    template<bool Const>
+    class iter {
+        using owner = typename std::conditional<Const, const front_coded_strings, front_coded_strings>::type;
+    public:
+        using difference_type = ptrdiff_t;
+        using value_type = std::string;
+        using reference = typename std::conditional<Const, std::string, typename front_coded_strings::reference>::type;
+        using pointer = void;
+        using iterator_category = std::random_access_iterator_tag;
+
+        iter() = default;
+
+        // This is the iterator-to-const_iterator implicit conversion.
+        template<bool C = Const, class = typename std::enable_if<C>::type>
+        iter(const iter<false>& other) : c_(other.c_), i_(other.i_) {}
+
+        reference operator*() const { return (*c_)[i_]; }
+        reference operator[](ptrdiff_t n) const { return *(*this + n); }
+
+        iter& operator++() { ++i_; return *this; }
+        iter& operator--() { --i_; return *this; }
+        iter operator++(int) { iter result(*this); ++*this; return result; }
+        iter operator--(int) { iter result(*this); --*this; return result; }
+        iter& operator+=(ptrdiff_t n) { i_ += static_cast<size_t>(n); return *this; }
+        iter& operator-=(ptrdiff_t n) { i_ -= static_cast<size_t>(n); return *this; }
+        friend iter operator+(iter it, ptrdiff_t n) { it += n; return it; }
+        friend iter operator+(ptrdiff_t n, iter it) { it += n; return it; }
+        friend iter operator-(iter it, ptrdiff_t n) { it -= n; return it; }
+        friend ptrdiff_t operator-(const iter& a, const iter& b) { return static_cast<ptrdiff_t>(a.i_ - b.i_); }
+        friend bool operator==(const iter& a, const iter& b) { return a.i_ == b.i_; }
+        friend bool operator!=(const iter& a, const iter& b) { return a.i_ != b.i_; }
+        friend bool operator<(const iter& a, const iter& b) { return a.i_ < b.i_; }
+        friend bool operator<=(const iter& a, const iter& b) { return a.i_ <= b.i_; }
+        friend bool operator>(const iter& a, const iter& b) { return a.i_ > b.i_; }
+        friend bool operator>=(const iter& a, const iter& b) { return a.i_ >= b.i_; }
+
+    private:
+        friend class front_coded_strings;
+        template<bool> friend class iter;
+        explicit iter(owner *c, size_t i) : c_(c), i_(i) {}
+
+        owner *c_ = nullptr;
+        size_t i_ = 0;
+    };
+
+    size_t block_size(size_t b) const {
+        return std::min(BlockSize, size_ - b * BlockSize);
+    }
+
+    // The number of arena bytes that block b's live keys occupy.
+    size_t block_extent(size_t b) const {
+        const char *first = arena_.data() + offsets_[b];
+        const char *p = first;
+        p += front_coded_detail::get_varint(p);
+        for (size_t k = block_size(b); k > 1; --k) {
+            front_coded_detail::get_varint(p);
+            p += front_coded_detail::get_varint(p);
+        }
+        return static_cast<size_t>(p - first);
+    }
+
+    std::string get(size_t i) const {
+        const char *p = arena_.data() + offsets_[i / BlockSize];
+        size_t n = front_coded_detail::get_varint(p);
+        std::string s(p, n);
+        p += n;
+        for (size_t k = i % BlockSize; k != 0; --k) {
+            size_t shared = front_coded_detail::get_varint(p);
+            n = front_coded_detail::get_varint(p);
+            s.resize(shared);
+            s.append(p, n);
+            p += n;
+        }
+        return s;
+    }
+
+    void decode_block(size_t b, std::vector<std::string>& out) const {
+        const char *p = arena_.data() + offsets_[b];
+        size_t n = front_coded_detail::get_varint(p);
+        out.emplace_back(p, n);
+        p += n;
+        for (size_t k = block_size(b); k > 1; --k) {
+            size_t shared = front_coded_detail::get_varint(p);
+            n = front_coded_detail::get_varint(p);
+            out.emplace_back(out.back(), 0, shared);
+            out.back().append(p, n);
+            p += n;
+        }
+    }
+
+    static std::string encode_block(const std::string *keys, size_t n) {
+        std::string out;
+        front_coded_detail::put_varint(out, keys[0].size());
+        out += keys[0];
+        for (size_t k = 1; k < n; ++k) {
+            const std::string& prev = keys[k-1];
+            const std::string& s = keys[k];
+            size_t shared = front_coded_detail::common_prefix(prev.data(), prev.size(), s.data(), s.size());
+            front_coded_detail::put_varint(out, shared);
+            front_coded_detail::put_varint(out, s.size() - shared);
+            out.append(s, shared, std::string::npos);
+        }
+        return out;
+    }
+
+    // Appends up to BlockSize keys as a new block; size_ must be a
+    // multiple of BlockSize.
+    void append_block(const std::string *keys, size_t n) {
+        if (n == 0) {
+            return;
+        }
+        std::string bytes = encode_block(keys, n);
+        offsets_.reserve(offsets_.size() + 1);
+        prefixes_.reserve(prefixes_.size() + 1);
+        arena_.append(bytes);
+        offsets_.push_back(arena_.size() - bytes.size());
+        prefixes_.push_back(front_coded_detail::prefix_of(keys[0].data(), keys[0].size()));
+        size_ += n;
+    }
+
+    // Assigns to one key by re-encoding its block, in place if the new
+    // encoding fits and at the end of the arena otherwise. The arena is
+    // compacted once more than half of it is dead.
+    void set(size_t i, const std::string& s) {
+        size_t b = i / BlockSize;
+        std::vector<std::string> keys;
+        keys.reserve(BlockSize);
+        this->decode_block(b, keys);
+        keys[i % BlockSize] = s;
+        std::string bytes = encode_block(keys.data(), keys.size());
+        size_t extent = block_extent(b);
+        if (bytes.size() <= extent) {
+            std::copy(bytes.begin(), bytes.end(), arena_.begin() + static_cast<ptrdiff_t>(offsets_[b]));
+            garbage_ += extent - bytes.size();
+        } else {
+            arena_.append(bytes);
+            offsets_[b] = arena_.size() - bytes.size();
+            garbage_ += extent;
+        }
+        prefixes_[b] = front_coded_detail::prefix_of(keys[0].data(), keys[0].size());
+        if (garbage_ > arena_.size() / 2) {
+            this->compact();
+        }
+    }
+
+    void compact() {
+        std::string arena;
+        arena.reserve(arena_.size() - garbage_);
+        std::vector<size_t> offsets(offsets_.size());
+        for (size_t b = 0; b < offsets_.size(); ++b) {
+            offsets[b] = arena.size();
+            arena.append(arena_, offsets_[b], block_extent(b));
+        }
+        arena_.swap(arena);
+        offsets_.swap(offsets);
+        garbage_ = 0;
+    }
+
+    // Drops the keys from position i on. Only whole blocks are released;
+    // the bytes of keys cut from the last block become garbage.
+    void truncate(size_t i) {
+        if (i == size_) {
+            return;
+        }
+        size_t blocks = (i + BlockSize - 1) / BlockSize;
+        for (size_t b = blocks; b < offsets_.size(); ++b) {
+            garbage_ += block_extent(b);
+        }
+        size_t last_extent = (blocks != 0) ? block_extent(blocks - 1) : 0;
+        offsets_.resize(blocks);
+        prefixes_.resize(blocks);
+        size_ = i;
+        if (blocks != 0) {
+            garbage_ += last_extent - block_extent(blocks - 1);
+        }
+        if (size_ == 0) {
+            this->clear();
+        } else if (garbage_ > arena_.size() / 2) {
+            this->compact();
+        }
+    }
+
+    // Decodes the keys from the block holding position i to the end, lets
+    // edit change them (given the offset of i among them), and re-encodes
+    // them after an unchanged copy of the blocks before.
+    template<class Edit>
+    void rebuild_from(size_t i, Edit edit) {
+        size_t first_block = i / BlockSize;
+        std::vector<std::string> tail;
+        tail.reserve(size_ - first_block * BlockSize + 1);
+        for (size_t b = first_block; b < offsets_.size(); ++b) {
+            this->decode_block(b, tail);
+        }
+        edit(tail, i - first_block * BlockSize);
+
+        front_coded_strings result;
+        result.offsets_.reserve(first_block + tail.size() / BlockSize + 1);
+        result.prefixes_.reserve(first_block + tail.size() / BlockSize + 1);
+        for (size_t b = 0; b < first_block; ++b) {
+            result.offsets_.push_back(result.arena_.size());
+            result.prefixes_.push_back(prefixes_[b]);
+            result.arena_.append(arena_, offsets_[b], block_extent(b));
+        }
+        result.size_ = first_block * BlockSize;
+        for (size_t k = 0; k < tail.size(); k += BlockSize) {
+            result.append_block(tail.data() + k, std::min(BlockSize, tail.size() - k));
+        }
+        this->swap(result);
+    }
+
+    std::string arena_;
+    std::vector<size_t> offsets_;
+    std::vector<uint64_t> prefixes_;
+    size_t size_ = 0;
+    size_t garbage_ = 0;
+};
+
+} // namespace stdext
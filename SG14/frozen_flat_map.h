@@ -0,0 +1,401 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+// frozen_flat_map is an immutable-keyed sibling of flat_map for tables
+// that are built once and then searched many times. Keys and values are
+// stored in Eytzinger (breadth-first) order, as in frozen_flat_set; the
+// mapped values stay assignable. Iteration visits the keys in sorted
+// order, by walking the implicit tree; iterators are bidirectional.
+
+#include "flat_map.h"
+#include "flat_search.h"
+
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stdext {
+
+namespace frozen_flatmap_detail {
+
+    template<class KeyIt, class MappedIt>
+    class iter {
+    public:
+        using difference_type = ptrdiff_t;
+        using value_type = std::pair<const typename std::iterator_traits<KeyIt>::value_type, typename std::iterator_traits<MappedIt>::value_type>;
+        using reference = std::pair<typename std::iterator_traits<KeyIt>::reference, typename std::iterator_traits<MappedIt>::reference>;
+        using pointer = flatmap_detail::arrow_proxy<reference>;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        iter() = default;
+        explicit iter(KeyIt kfirst, MappedIt vfirst, size_t n, size_t k) : kfirst_(kfirst), vfirst_(vfirst), n_(n), k_(k) {}
+
+        // This is the iterator-to-const_iterator implicit conversion.
+        template<class CK, class CM,
+                 class = typename std::enable_if<std::is_convertible<CK, KeyIt>::value>::type,
+                 class = typename std::enable_if<std::is_convertible<CM, MappedIt>::value>::type>
+        iter(const iter<CK, CM>& other) :
+            kfirst_(other.private_impl_getkeys()), vfirst_(other.private_impl_getmapped()),
+            n_(other.private_impl_getsize()), k_(other.private_impl_getnode()) {}
+
+        reference operator*() const {
+            ptrdiff_t i = static_cast<ptrdiff_t>(k_ - 1);
+            return reference{kfirst_[i], vfirst_[i]};
+        }
+
+        pointer operator->() const {
+            return pointer{**this};
+        }
+
+        iter& operator++() { k_ = flat_search_detail::eytzinger_next(k_, n_); return *this; }
+        iter& operator--() { k_ = flat_search_detail::eytzinger_prev(k_, n_); return *this; }
+        iter operator++(int) { iter result(*this); ++*this; return result; }
+        iter operator--(int) { iter result(*this); --*this; return result; }
+        friend bool operator==(const iter& a, const iter& b) { return a.k_ == b.k_; }
+        friend bool operator!=(const iter& a, const iter& b) { return a.k_ != b.k_; }
+
+        KeyIt private_impl_getkeys() const { return kfirst_; }
+        MappedIt private_impl_getmapped() const { return vfirst_; }
+        size_t private_impl_getsize() const { return n_; }
+        // The 1-based position in the Eytzinger layout, or 0 for end().
+        size_t private_impl_getnode() const { return k_; }
+
+    private:
+        KeyIt kfirst_{};
+        MappedIt vfirst_{};
+        size_t n_ = 0;
+        size_t k_ = 0;
+    };
+
+} // namespace frozen_flatmap_detail
+
+template<
+    class Key,
+    class Mapped,
+    class Compare = std::less<Key>,
+    class KeyContainer = std::vector<Key>,
+    class MappedContainer = std::vector<Mapped>
+>
+class frozen_flat_map {
+    static_assert(flatmap_detail::is_random_access_iterator<typename KeyContainer::iterator>::value, "");
+    static_assert(flatmap_detail::is_random_access_iterator<typename MappedContainer::iterator>::value, "");
+    static_assert(std::is_same<Key, typename KeyContainer::value_type>::value, "");
+    static_assert(std::is_same<Mapped, typename MappedContainer::value_type>::value, "");
+public:
+    using key_type = Key;
+    using mapped_type = Mapped;
+    using value_type = std::pair<const Key, Mapped>;
+    using key_compare = Compare;
+    using const_key_reference = typename KeyContainer::const_reference;
+    using mapped_reference = typename MappedContainer::reference;
+    using const_mapped_reference = typename MappedContainer::const_reference;
+    using reference = std::pair<const_key_reference, mapped_reference>;
+    using const_reference = std::pair<const_key_reference, const_mapped_reference>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using iterator = frozen_flatmap_detail::iter<typename KeyContainer::const_iterator, typename MappedContainer::iterator>;
+    using const_iterator = frozen_flatmap_detail::iter<typename KeyContainer::const_iterator, typename MappedContainer::const_iterator>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using key_container_type = KeyContainer;
+    using mapped_container_type = MappedContainer;
+
+    frozen_flat_map() : frozen_flat_map(Compare()) {}
+
+    explicit frozen_flat_map(const Compare& comp) : c_{}, compare_(comp) {}
+
+    // The keys must already be sorted and unique with respect to comp,
+    // and values[i] is the value mapped to keys[i].
+    frozen_flat_map(stdext::sorted_unique_t, KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+        : c_{static_cast<KeyContainer&&>(keys), static_cast<MappedContainer&&>(values)}, compare_(comp)
+    {
+        this->relayout();
+    }
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    frozen_flat_map(stdext::sorted_unique_t, InputIterator first, InputIterator last, const Compare& comp = Compare())
+        : c_{}, compare_(comp)
+    {
+        while (first != last) {
+            c_.keys.insert(c_.keys.end(), first->first);
+            c_.values.insert(c_.values.end(), first->second);
+            ++first;
+        }
+        this->relayout();
+    }
+
+    frozen_flat_map(stdext::sorted_unique_t s, std::initializer_list<value_type> il, const Compare& comp = Compare())
+        : frozen_flat_map(s, il.begin(), il.end(), comp) {}
+
+    explicit frozen_flat_map(flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>&& fm)
+        : c_{}, compare_(fm.key_comp())
+    {
+        auto c = static_cast<flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>&&>(fm).extract();
+        c_.keys = static_cast<KeyContainer&&>(c.keys);
+        c_.values = static_cast<MappedContainer&&>(c.values);
+        this->relayout();
+    }
+
+    explicit frozen_flat_map(const flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& fm)
+        : frozen_flat_map(stdext::sorted_unique, fm.keys(), fm.values(), fm.key_comp()) {}
+
+// ========================================================== OTHER MEMBERS
+
+    iterator begin() noexcept { return make_iterator(flat_search_detail::eytzinger_first(size())); }
+    const_iterator begin() const noexcept { return make_iterator(flat_search_detail::eytzinger_first(size())); }
+    iterator end() noexcept { return make_iterator(0); }
+    const_iterator end() const noexcept { return make_iterator(0); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    bool empty() const noexcept { return c_.keys.empty(); }
+    size_type size() const noexcept { return c_.keys.size(); }
+    size_type max_size() const noexcept { return std::min<size_type>(c_.keys.max_size(), c_.values.max_size()); }
+
+    mapped_reference at(const Key& k) {
+        auto it = this->find(k);
+        if (it == end()) {
+            throw std::out_of_range("frozen_flat_map::at");
+        }
+        return it->second;
+    }
+
+    const_mapped_reference at(const Key& k) const {
+        auto it = this->find(k);
+        if (it == end()) {
+            throw std::out_of_range("frozen_flat_map::at");
+        }
+        return it->second;
+    }
+
+    // The keys and values in Eytzinger order.
+    const KeyContainer& keys() const noexcept { return c_.keys; }
+    const MappedContainer& values() const noexcept { return c_.values; }
+
+    // Returns the elements to sorted order and hands them back as a flat_map.
+    flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer> thaw() && {
+        auto from = flat_search_detail::sorted_order(size());
+        auto from2 = from;
+        flat_search_detail::permute(c_.keys, from);
+        flat_search_detail::permute(c_.values, from2);
+        flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer> result(compare_);
+        result.replace(static_cast<KeyContainer&&>(c_.keys), static_cast<MappedContainer&&>(c_.values));
+        c_.keys.clear();
+        c_.values.clear();
+        return result;
+    }
+
+    void swap(frozen_flat_map& fm) noexcept
+#if defined(__cpp_lib_is_swappable)
+        (std::is_nothrow_swappable<KeyContainer>::value && std::is_nothrow_swappable<MappedContainer>::value && std::is_nothrow_swappable<Compare>::value)
+#endif
+    {
+        using std::swap;
+        swap(compare_, fm.compare_);
+        swap(c_.keys, fm.c_.keys);
+        swap(c_.values, fm.c_.values);
+    }
+
+    key_compare key_comp() const { return compare_; }
+
+    iterator find(const Key& k) {
+        return make_iterator(this->find_node(k));
+    }
+
+    const_iterator find(const Key& k) const {
+        return make_iterator(this->find_node(k));
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator find(const K& x) {
+        return make_iterator(this->find_node(x));
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    const_iterator find(const K& x) const {
+        return make_iterator(this->find_node(x));
+    }
+
+    size_type count(const Key& k) const {
+        return this->contains(k) ? 1 : 0;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    size_type count(const K& x) const {
+        auto its = this->equal_range(x);
+        return static_cast<size_type>(std::distance(its.first, its.second));
+    }
+
+    bool contains(const Key& k) const {
+        return this->find_node(k) != 0;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    bool contains(const K& x) const {
+        return this->find_node(x) != 0;
+    }
+
+    iterator lower_bound(const Key& k) { return make_iterator(this->lower_bound_node(k)); }
+    const_iterator lower_bound(const Key& k) const { return make_iterator(this->lower_bound_node(k)); }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator lower_bound(const K& x) { return make_iterator(this->lower_bound_node(x)); }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    const_iterator lower_bound(const K& x) const { return make_iterator(this->lower_bound_node(x)); }
+
+    iterator upper_bound(const Key& k) { return make_iterator(this->upper_bound_node(k)); }
+    const_iterator upper_bound(const Key& k) const { return make_iterator(this->upper_bound_node(k)); }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator upper_bound(const K& x) { return make_iterator(this->upper_bound_node(x)); }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    const_iterator upper_bound(const K& x) const { return make_iterator(this->upper_bound_node(x)); }
+
+    std::pair<iterator, iterator> equal_range(const Key& k) {
+        auto it = this->lower_bound(k);
+        return {it, this->past_if_equal(it, k)};
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key& k) const {
+        auto it = this->lower_bound(k);
+        return {it, this->past_if_equal(it, k)};
+    }
+
+    // A heterogeneous key may be equivalent to any number of keys.
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& x) {
+        return {this->lower_bound(x), this->upper_bound(x)};
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& x) const {
+        return {this->lower_bound(x), this->upper_bound(x)};
+    }
+
+private:
+    void relayout() {
+        auto from = flat_search_detail::eytzinger_order(size());
+        auto from2 = from;
+        flat_search_detail::permute(c_.keys, from);
+        flat_search_detail::permute(c_.values, from2);
+    }
+
+    template<class K>
+    size_t lower_bound_node(const K& x) const {
+        return flat_search_detail::eytzinger_search(c_.keys.begin(), c_.keys.size(), [&](const Key& elt) {
+            return bool(compare_(elt, x));
+        });
+    }
+
+    template<class K>
+    size_t upper_bound_node(const K& x) const {
+        return flat_search_detail::eytzinger_search(c_.keys.begin(), c_.keys.size(), [&](const Key& elt) {
+            return !bool(compare_(x, elt));
+        });
+    }
+
+    template<class K>
+    size_t find_node(const K& x) const {
+        size_t k = this->lower_bound_node(x);
+        if (k == 0) {
+            return 0;
+        }
+        const Key& elt = c_.keys[k - 1];
+        return bool(compare_(x, elt)) ? 0 : k;
+    }
+
+    template<class It, class K>
+    It past_if_equal(It it, const K& x) const {
+        if (it.private_impl_getnode() != 0 && !bool(compare_(x, it->first))) {
+            ++it;
+        }
+        return it;
+    }
+
+    iterator make_iterator(size_t k) {
+        return iterator(c_.keys.cbegin(), c_.values.begin(), size(), k);
+    }
+
+    const_iterator make_iterator(size_t k) const {
+        return const_iterator(c_.keys.cbegin(), c_.values.cbegin(), size(), k);
+    }
+
+    struct containers {
+        KeyContainer keys;
+        MappedContainer values;
+    } c_;
+    Compare compare_;
+};
+
+template<class Key, class Mapped, class Compare, class KeyContainer, class MappedContainer>
+bool operator==(const frozen_flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& x, const frozen_flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& y)
+{
+    // Equal maps of the same size share one layout.
+    return x.keys() == y.keys() && x.values() == y.values();
+}
+
+template<class Key, class Mapped, class Compare, class KeyContainer, class MappedContainer>
+bool operator!=(const frozen_flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& x, const frozen_flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& y)
+{
+    return !(x == y);
+}
+
+template<class Key, class Mapped, class Compare, class KeyContainer, class MappedContainer>
+void swap(frozen_flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& x, frozen_flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>& y) noexcept(noexcept(x.swap(y)))
+{
+    return x.swap(y);
+}
+
+} // namespace stdext
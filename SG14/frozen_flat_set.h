@@ -0,0 +1,288 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+// frozen_flat_set is an immutable sibling of flat_set for tables that are
+// built once and then searched many times. Its keys are stored in
+// Eytzinger (breadth-first) order, so the first levels of every search
+// share a few cache lines and deeper levels are prefetched ahead of use.
+// Iteration still visits the keys in sorted order, by walking the
+// implicit tree; iterators are bidirectional.
+
+#include "flat_search.h"
+#include "flat_set.h"
+
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stdext {
+
+namespace frozen_flatset_detail {
+
+    template<class KeyIt>
+    class iter {
+    public:
+        using difference_type = ptrdiff_t;
+        using value_type = typename std::iterator_traits<KeyIt>::value_type;
+        using reference = typename std::iterator_traits<KeyIt>::reference;
+        using pointer = typename std::iterator_traits<KeyIt>::pointer;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        iter() = default;
+        explicit iter(KeyIt first, size_t n, size_t k) : first_(first), n_(n), k_(k) {}
+
+        reference operator*() const { return first_[static_cast<ptrdiff_t>(k_ - 1)]; }
+        pointer operator->() const { return std::addressof(**this); }
+
+        iter& operator++() { k_ = flat_search_detail::eytzinger_next(k_, n_); return *this; }
+        iter& operator--() { k_ = flat_search_detail::eytzinger_prev(k_, n_); return *this; }
+        iter operator++(int) { iter result(*this); ++*this; return result; }
+        iter operator--(int) { iter result(*this); --*this; return result; }
+        friend bool operator==(const iter& a, const iter& b) { return a.k_ == b.k_; }
+        friend bool operator!=(const iter& a, const iter& b) { return a.k_ != b.k_; }
+
+        // The 1-based position in the Eytzinger layout, or 0 for end().
+        size_t private_impl_getnode() const { return k_; }
+
+    private:
+        KeyIt first_{};
+        size_t n_ = 0;
+        size_t k_ = 0;
+    };
+
+} // namespace frozen_flatset_detail
+
+template<
+    class Key,
+    class Compare = std::less<Key>,
+    class KeyContainer = std::vector<Key>
+>
+class frozen_flat_set {
+    static_assert(flatset_detail::is_random_access_iterator<typename KeyContainer::iterator>::value, "");
+    static_assert(std::is_same<Key, typename KeyContainer::value_type>::value, "");
+public:
+    using key_type = Key;
+    using key_compare = Compare;
+    using value_type = Key;
+    using value_compare = Compare;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using iterator = frozen_flatset_detail::iter<typename KeyContainer::const_iterator>;
+    using const_iterator = iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using container_type = KeyContainer;
+
+    frozen_flat_set() : frozen_flat_set(Compare()) {}
+
+    explicit frozen_flat_set(const Compare& comp) : c_(), compare_(comp) {}
+
+    // The keys must already be sorted and unique with respect to comp.
+    frozen_flat_set(stdext::sorted_unique_t, KeyContainer ctr, const Compare& comp = Compare())
+        : c_(static_cast<KeyContainer&&>(ctr)), compare_(comp)
+    {
+        auto from = flat_search_detail::eytzinger_order(c_.size());
+        flat_search_detail::permute(c_, from);
+    }
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatset_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    frozen_flat_set(stdext::sorted_unique_t s, InputIterator first, InputIterator last, const Compare& comp = Compare())
+        : frozen_flat_set(s, KeyContainer(first, last), comp) {}
+
+    frozen_flat_set(stdext::sorted_unique_t s, std::initializer_list<Key> il, const Compare& comp = Compare())
+        : frozen_flat_set(s, il.begin(), il.end(), comp) {}
+
+    explicit frozen_flat_set(flat_set<Key, Compare, KeyContainer>&& fs)
+        : frozen_flat_set(stdext::sorted_unique, static_cast<flat_set<Key, Compare, KeyContainer>&&>(fs).extract(), fs.key_comp()) {}
+
+    explicit frozen_flat_set(const flat_set<Key, Compare, KeyContainer>& fs)
+        : frozen_flat_set(stdext::sorted_unique, KeyContainer(fs.begin(), fs.end()), fs.key_comp()) {}
+
+// ========================================================== OTHER MEMBERS
+
+    iterator begin() const noexcept { return make_iterator(flat_search_detail::eytzinger_first(size())); }
+    iterator end() const noexcept { return make_iterator(0); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    bool empty() const noexcept { return c_.empty(); }
+    size_type size() const noexcept { return c_.size(); }
+    size_type max_size() const noexcept { return c_.max_size(); }
+
+    // The keys in Eytzinger order.
+    const KeyContainer& keys() const noexcept { return c_; }
+
+    // Returns the keys to sorted order and hands them back as a flat_set.
+    flat_set<Key, Compare, KeyContainer> thaw() && {
+        auto from = flat_search_detail::sorted_order(c_.size());
+        flat_search_detail::permute(c_, from);
+        flat_set<Key, Compare, KeyContainer> result(compare_);
+        result.replace(static_cast<KeyContainer&&>(c_));
+        c_.clear();
+        return result;
+    }
+
+    void swap(frozen_flat_set& fs) noexcept
+#if defined(__cpp_lib_is_swappable)
+        (std::is_nothrow_swappable<KeyContainer>::value && std::is_nothrow_swappable<Compare>::value)
+#endif
+    {
+        using std::swap;
+        swap(c_, fs.c_);
+        swap(compare_, fs.compare_);
+    }
+
+    key_compare key_comp() const { return compare_; }
+    value_compare value_comp() const { return compare_; }
+
+    iterator find(const Key& x) const {
+        auto it = this->lower_bound(x);
+        if (it == end() || compare_(x, *it)) {
+            return end();
+        }
+        return it;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator find(const K& x) const {
+        auto it = this->lower_bound(x);
+        if (it == end() || compare_(x, *it)) {
+            return end();
+        }
+        return it;
+    }
+
+    size_type count(const Key& x) const {
+        return this->contains(x) ? 1 : 0;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    size_type count(const K& x) const {
+        auto its = this->equal_range(x);
+        return static_cast<size_type>(std::distance(its.first, its.second));
+    }
+
+    bool contains(const Key& x) const {
+        return this->find(x) != this->end();
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    bool contains(const K& x) const {
+        return this->find(x) != this->end();
+    }
+
+    iterator lower_bound(const Key& x) const {
+        return make_iterator(flat_search_detail::eytzinger_search(c_.begin(), c_.size(), [&](const Key& elt) {
+            return bool(compare_(elt, x));
+        }));
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator lower_bound(const K& x) const {
+        return make_iterator(flat_search_detail::eytzinger_search(c_.begin(), c_.size(), [&](const Key& elt) {
+            return bool(compare_(elt, x));
+        }));
+    }
+
+    iterator upper_bound(const Key& x) const {
+        return make_iterator(flat_search_detail::eytzinger_search(c_.begin(), c_.size(), [&](const Key& elt) {
+            return !bool(compare_(x, elt));
+        }));
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator upper_bound(const K& x) const {
+        return make_iterator(flat_search_detail::eytzinger_search(c_.begin(), c_.size(), [&](const Key& elt) {
+            return !bool(compare_(x, elt));
+        }));
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key& x) const {
+        auto it = this->lower_bound(x);
+        auto last = it;
+        if (last != end() && !bool(compare_(x, *last))) {
+            ++last;
+        }
+        return {it, last};
+    }
+
+    // A heterogeneous key may be equivalent to any number of keys.
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& x) const {
+        return {this->lower_bound(x), this->upper_bound(x)};
+    }
+
+private:
+    iterator make_iterator(size_t k) const {
+        return iterator(c_.begin(), c_.size(), k);
+    }
+
+    KeyContainer c_;
+    Compare compare_;
+};
+
+template<class Key, class Compare, class KeyContainer>
+bool operator==(const frozen_flat_set<Key, Compare, KeyContainer>& x, const frozen_flat_set<Key, Compare, KeyContainer>& y)
+{
+    // Equal sets of the same size share one layout.
+    return x.keys() == y.keys();
+}
+
+template<class Key, class Compare, class KeyContainer>
+bool operator!=(const frozen_flat_set<Key, Compare, KeyContainer>& x, const frozen_flat_set<Key, Compare, KeyContainer>& y)
+{
+    return !(x == y);
+}
+
+template<class Key, class Compare, class KeyContainer>
+void swap(frozen_flat_set<Key, Compare, KeyContainer>& x, frozen_flat_set<Key, Compare, KeyContainer>& y) noexcept(noexcept(x.swap(y)))
+{
+    return x.swap(y);
+}
+
+} // namespace stdext
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <type_traits>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
 #include <cassert>
 
+#ifndef SG14_RING_CACHE_LINE_SIZE
+#define SG14_RING_CACHE_LINE_SIZE 64
+#endif
+
 namespace sg14
 {
 	template <typename T>
@@ -31,6 +40,29 @@ namespace sg14
 	template <typename, bool>
 	class ring_iterator;
 
+	// A contiguous run of elements inside a ring's storage.
+	// Bulk access to a ring is expressed as at most two of these.
+	template <typename T>
+	class ring_segment
+	{
+	public:
+		using size_type = std::size_t;
+		using pointer = T*;
+
+		ring_segment() noexcept = default;
+		ring_segment(pointer data, size_type size) noexcept;
+
+		pointer data() const noexcept;
+		size_type size() const noexcept;
+		bool empty() const noexcept;
+		pointer begin() const noexcept;
+		pointer end() const noexcept;
+
+	private:
+		pointer m_data = nullptr;
+		size_type m_size = 0;
+	};
+
 	template<typename T, class Popper = default_popper<T>>
 	class ring_span
 	{
@@ -45,6 +77,10 @@ namespace sg14
 		using const_iterator = ring_iterator<type, true>;
 		using reverse_iterator = std::reverse_iterator<iterator>;
 		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using segment = ring_segment<T>;
+		using const_segment = ring_segment<const T>;
+		using segment_pair = std::pair<segment, segment>;
+		using const_segment_pair = std::pair<const_segment, const_segment>;
 
 		friend class ring_iterator<type, false>;
 		friend class ring_iterator<type, true>;
@@ -90,6 +126,29 @@ namespace sg14
 		void emplace_back(FromType&&... from_value) noexcept(std::is_nothrow_constructible<T, FromType...>::value && std::is_nothrow_move_assignable<T>::value);
 		auto pop_front();
 
+		// Bulk operations. push_back(first, last) behaves like pushing each
+		// element in turn (so the oldest elements are overwritten once the
+		// ring is full) but copies whole segments at a time.
+		// pop_front_n passes each of the n front elements through the popper
+		// and writes the results to out.
+		template<class InputIterator, typename = std::enable_if_t<!std::is_integral<InputIterator>::value>>
+		void push_back(InputIterator first, InputIterator last);
+		template<class OutputIterator>
+		OutputIterator pop_front_n(OutputIterator out, size_type n);
+
+		// Contiguous access. readable_segments() returns the elements in
+		// [begin(), end()) as at most two runs of storage, front first.
+		// writable_segments() returns the capacity() - size() unused slots
+		// after back(), in the order push_back would fill them.
+		// After writing into the first n writable slots, commit_back(n) makes
+		// them part of the ring; drop_front(n) removes the first n elements
+		// without calling the popper, e.g. after copying them out directly.
+		segment_pair readable_segments() noexcept;
+		const_segment_pair readable_segments() const noexcept;
+		segment_pair writable_segments() noexcept;
+		void commit_back(size_type n) noexcept;
+		void drop_front(size_type n) noexcept;
+
 		void swap(type& rhs) noexcept;// (std::is_nothrow_swappable<Popper>::value);
 
 		// Example implementation
@@ -98,6 +157,12 @@ namespace sg14
 		const_reference at(size_type idx) const noexcept;
 		size_type back_idx() const noexcept;
 		void increase_size() noexcept;
+		template<class InputIterator>
+		void push_back_range(InputIterator first, InputIterator last, std::input_iterator_tag);
+		template<class RandomAccessIterator>
+		void push_back_range(RandomAccessIterator first, RandomAccessIterator last, std::random_access_iterator_tag);
+		template<class Segment>
+		std::pair<Segment, Segment> split(size_type idx, size_type count) const noexcept;
 
 		T* m_data;
 		size_type m_size;
@@ -162,6 +227,389 @@ namespace sg14
 
 	template <typename Ring, bool C>
 	ring_iterator<Ring, C> operator-(ring_iterator<Ring, C> it, std::ptrdiff_t) noexcept;
+
+	// A ring_span whose capacity must be a power of two. Instead of a front
+	// index and a size it keeps two free-running counters, so every index
+	// computation is a mask rather than a modulo, and full and empty are
+	// told apart by the counters' difference alone. Because the capacity
+	// divides the counters' modulus, wrapping of the counters is harmless.
+	template<typename T, class Popper = default_popper<T>>
+	class pow2_ring_span
+	{
+	public:
+		using type = pow2_ring_span<T, Popper>;
+		using size_type = std::size_t;
+		using value_type = T;
+		using pointer = T*;
+		using reference = T&;
+		using const_reference = const T&;
+		using iterator = ring_iterator<type, false>;
+		using const_iterator = ring_iterator<type, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		friend class ring_iterator<type, false>;
+		friend class ring_iterator<type, true>;
+
+		template <class ContiguousIterator>
+		pow2_ring_span(ContiguousIterator begin, ContiguousIterator end, Popper p = Popper()) noexcept;
+
+		template <class ContiguousIterator>
+		pow2_ring_span(ContiguousIterator begin, ContiguousIterator end, ContiguousIterator first, size_type size, Popper p = Popper()) noexcept;
+
+		pow2_ring_span(pow2_ring_span&&) = default;
+		pow2_ring_span& operator=(pow2_ring_span&&) = default;
+
+		bool empty() const noexcept;
+		bool full() const noexcept;
+		size_type size() const noexcept;
+		size_type capacity() const noexcept;
+
+		reference front() noexcept;
+		const_reference front() const noexcept;
+		reference back() noexcept;
+		const_reference back() const noexcept;
+
+		iterator begin() noexcept;
+		const_iterator begin() const noexcept;
+		iterator end() noexcept;
+		const_iterator end() const noexcept;
+
+		const_iterator cbegin() const noexcept;
+		const_reverse_iterator crbegin() const noexcept;
+		reverse_iterator rbegin() noexcept;
+		const_reverse_iterator rbegin() const noexcept;
+		const_iterator cend() const noexcept;
+		const_reverse_iterator crend() const noexcept;
+		reverse_iterator rend() noexcept;
+		const_reverse_iterator rend() const noexcept;
+
+		template<bool b = true, typename = std::enable_if_t<b && std::is_copy_assignable<T>::value>>
+		void push_back(const value_type& from_value) noexcept(std::is_nothrow_copy_assignable<T>::value);
+		template<bool b = true, typename = std::enable_if_t<b && std::is_move_assignable<T>::value>>
+		void push_back(value_type&& from_value) noexcept(std::is_nothrow_move_assignable<T>::value);
+		template<class... FromType>
+		void emplace_back(FromType&&... from_value) noexcept(std::is_nothrow_constructible<T, FromType...>::value && std::is_nothrow_move_assignable<T>::value);
+		auto pop_front();
+
+		void swap(type& rhs) noexcept;// (std::is_nothrow_swappable<Popper>::value);
+
+		// Example implementation
+	private:
+		reference at(size_type idx) noexcept;
+		const_reference at(size_type idx) const noexcept;
+		void increase_size() noexcept;
+
+		T* m_data;
+		size_type m_mask;
+		size_type m_head;
+		size_type m_tail;
+		Popper m_popper;
+	};
+
+	template<typename T, class Popper>
+	void swap(pow2_ring_span<T, Popper>&, pow2_ring_span<T, Popper>&) noexcept;
+
+	// An owning ring with inline storage for N elements; it never allocates.
+	// Elements are constructed in place when pushed and destroyed when
+	// popped, so T need not be default constructible. Like ring_span,
+	// pushing onto a full static_ring replaces the oldest element.
+	template<typename T, std::size_t N>
+	class static_ring
+	{
+		static_assert(N > 0, "static_ring must have a non-zero capacity");
+	public:
+		using type = static_ring<T, N>;
+		using size_type = std::size_t;
+		using value_type = T;
+		using pointer = T*;
+		using reference = T&;
+		using const_reference = const T&;
+		using iterator = ring_iterator<type, false>;
+		using const_iterator = ring_iterator<type, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		friend class ring_iterator<type, false>;
+		friend class ring_iterator<type, true>;
+
+		static_ring() noexcept;
+		static_ring(const static_ring& rhs);
+		static_ring(static_ring&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value);
+		static_ring& operator=(const static_ring& rhs);
+		static_ring& operator=(static_ring&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value);
+		~static_ring();
+
+		bool empty() const noexcept;
+		bool full() const noexcept;
+		size_type size() const noexcept;
+		static constexpr size_type capacity() noexcept;
+
+		reference front() noexcept;
+		const_reference front() const noexcept;
+		reference back() noexcept;
+		const_reference back() const noexcept;
+
+		iterator begin() noexcept;
+		const_iterator begin() const noexcept;
+		iterator end() noexcept;
+		const_iterator end() const noexcept;
+
+		const_iterator cbegin() const noexcept;
+		const_reverse_iterator crbegin() const noexcept;
+		reverse_iterator rbegin() noexcept;
+		const_reverse_iterator rbegin() const noexcept;
+		const_iterator cend() const noexcept;
+		const_reverse_iterator crend() const noexcept;
+		reverse_iterator rend() noexcept;
+		const_reverse_iterator rend() const noexcept;
+
+		void push_back(const value_type& from_value);
+		void push_back(value_type&& from_value);
+		template<class... FromType>
+		reference emplace_back(FromType&&... from_value);
+		value_type pop_front();
+		void clear() noexcept;
+
+		// Example implementation
+	private:
+		reference at(size_type idx) noexcept;
+		const_reference at(size_type idx) const noexcept;
+		void* slot(size_type idx) noexcept;
+		void destroy_front() noexcept;
+
+		std::aligned_storage_t<sizeof(T), alignof(T)> m_storage[N];
+		size_type m_size;
+		size_type m_front_idx;
+	};
+
+	// An owning, growable ring. Its capacity is always zero or a power of
+	// two, so indexing is a mask. When a push finds the ring full, the
+	// elements are moved into a buffer twice the size, linearized so the
+	// front lands at index zero. Elements are constructed in place and
+	// never default constructed.
+	template<typename T, class Allocator = std::allocator<T>>
+	class dynamic_ring
+	{
+		static_assert(std::is_same<T, typename Allocator::value_type>::value, "Allocator::value_type must be T");
+		using alloc_traits = std::allocator_traits<Allocator>;
+	public:
+		using type = dynamic_ring<T, Allocator>;
+		using allocator_type = Allocator;
+		using size_type = std::size_t;
+		using value_type = T;
+		using pointer = T*;
+		using reference = T&;
+		using const_reference = const T&;
+		using iterator = ring_iterator<type, false>;
+		using const_iterator = ring_iterator<type, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		friend class ring_iterator<type, false>;
+		friend class ring_iterator<type, true>;
+
+		dynamic_ring() noexcept(noexcept(Allocator()));
+		explicit dynamic_ring(const Allocator& alloc) noexcept;
+		dynamic_ring(const dynamic_ring& rhs);
+		dynamic_ring(dynamic_ring&& rhs) noexcept;
+		dynamic_ring& operator=(const dynamic_ring& rhs);
+		dynamic_ring& operator=(dynamic_ring&& rhs);
+		~dynamic_ring();
+
+		allocator_type get_allocator() const noexcept;
+
+		bool empty() const noexcept;
+		size_type size() const noexcept;
+		size_type capacity() const noexcept;
+		// Rounds n up to a power of two.
+		void reserve(size_type n);
+
+		reference front() noexcept;
+		const_reference front() const noexcept;
+		reference back() noexcept;
+		const_reference back() const noexcept;
+
+		iterator begin() noexcept;
+		const_iterator begin() const noexcept;
+		iterator end() noexcept;
+		const_iterator end() const noexcept;
+
+		const_iterator cbegin() const noexcept;
+		const_reverse_iterator crbegin() const noexcept;
+		reverse_iterator rbegin() noexcept;
+		const_reverse_iterator rbegin() const noexcept;
+		const_iterator cend() const noexcept;
+		const_reverse_iterator crend() const noexcept;
+		reverse_iterator rend() noexcept;
+		const_reverse_iterator rend() const noexcept;
+
+		void push_back(const value_type& from_value);
+		void push_back(value_type&& from_value);
+		template<class... FromType>
+		reference emplace_back(FromType&&... from_value);
+		value_type pop_front();
+		void clear() noexcept;
+
+		void swap(type& rhs) noexcept;
+
+		// Example implementation
+	private:
+		reference at(size_type idx) noexcept;
+		const_reference at(size_type idx) const noexcept;
+		void relocate_into(T* buffer);
+		void adopt(T* buffer, size_type new_capacity) noexcept;
+		void release() noexcept;
+
+		Allocator m_alloc;
+		T* m_data;
+		size_type m_capacity;
+		size_type m_size;
+		size_type m_front_idx;
+	};
+
+	template<typename T, class Allocator>
+	void swap(dynamic_ring<T, Allocator>&, dynamic_ring<T, Allocator>&) noexcept;
+
+	// A single-producer/single-consumer ring over the same kind of contiguous
+	// storage as ring_span. Exactly one thread may call the try_push/try_emplace
+	// functions and exactly one (possibly different) thread may call try_pop_front.
+	// The producer and consumer indices live on separate cache lines and are
+	// published with release stores and observed with acquire loads, so neither
+	// side ever blocks or takes a lock.
+	// Unlike ring_span, a full spsc_ring_span refuses new elements rather than
+	// overwriting the oldest one, since the consumer might be reading it.
+	// As with pow2_ring_span, the capacity must be a power of two, so that
+	// indexing is a mask and wrapping of the free-running counters is harmless.
+	template<typename T>
+	class spsc_ring_span
+	{
+	public:
+		using type = spsc_ring_span<T>;
+		using size_type = std::size_t;
+		using value_type = T;
+		using pointer = T*;
+		using reference = T&;
+		using const_reference = const T&;
+
+		template <class ContiguousIterator>
+		spsc_ring_span(ContiguousIterator begin, ContiguousIterator end) noexcept;
+
+		spsc_ring_span(const spsc_ring_span&) = delete;
+		spsc_ring_span& operator=(const spsc_ring_span&) = delete;
+
+		// empty(), full() and size() are exact when called from the producer or
+		// consumer thread with the other side quiescent; otherwise they are a snapshot.
+		bool empty() const noexcept;
+		bool full() const noexcept;
+		size_type size() const noexcept;
+		size_type capacity() const noexcept;
+
+		// Producer side.
+		template<bool b = true, typename = std::enable_if_t<b && std::is_copy_assignable<T>::value>>
+		bool try_push_back(const value_type& from_value) noexcept(std::is_nothrow_copy_assignable<T>::value);
+		template<bool b = true, typename = std::enable_if_t<b && std::is_move_assignable<T>::value>>
+		bool try_push_back(value_type&& from_value) noexcept(std::is_nothrow_move_assignable<T>::value);
+		template<class... FromType>
+		bool try_emplace_back(FromType&&... from_value) noexcept(std::is_nothrow_constructible<T, FromType...>::value && std::is_nothrow_move_assignable<T>::value);
+
+		// Consumer side.
+		template<bool b = true, typename = std::enable_if_t<b && std::is_move_assignable<T>::value>>
+		bool try_pop_front(value_type& to_value) noexcept(std::is_nothrow_move_assignable<T>::value);
+
+		// Example implementation
+	private:
+		template<class Assign>
+		bool try_produce(Assign&& assign);
+
+		// Read-only after construction; shared by both sides.
+		T* m_data;
+		size_type m_mask;
+
+		// Written by the producer. The counters increase monotonically and
+		// are masked with m_mask only when indexing m_data.
+		alignas(SG14_RING_CACHE_LINE_SIZE) std::atomic<size_type> m_tail;
+		size_type m_cached_head;
+
+		// Written by the consumer.
+		alignas(SG14_RING_CACHE_LINE_SIZE) std::atomic<size_type> m_head;
+		size_type m_cached_tail;
+	};
+
+	template<typename T>
+	class mpmc_ring_span;
+
+	// One slot of an mpmc_ring_span. The sequence number tells producers and
+	// consumers whose turn it is to touch m_value, so threads only ever
+	// contend on the cells they are actually reading or writing.
+	template<typename T>
+	class mpmc_ring_cell
+	{
+	public:
+		mpmc_ring_cell() = default;
+		mpmc_ring_cell(const mpmc_ring_cell&) = delete;
+		mpmc_ring_cell& operator=(const mpmc_ring_cell&) = delete;
+
+	private:
+		friend class mpmc_ring_span<T>;
+		std::atomic<std::size_t> m_sequence{0};
+		T m_value{};
+	};
+
+	// A bounded multi-producer/multi-consumer ring over contiguous storage of
+	// mpmc_ring_cell<T>. Any number of threads may push and pop concurrently;
+	// producers serialize only on a CAS of the tail counter and consumers only
+	// on a CAS of the head counter, and the element hand-off itself is
+	// synchronized per cell. Values are assigned into already-constructed
+	// slots, so a payload such as inplace_function never allocates.
+	// If assigning into or out of a slot throws, the ring must not be used again.
+	// The capacity must be a power of two, so that a position maps to its cell
+	// with a mask and wrapping of the free-running counters is harmless.
+	template<typename T>
+	class mpmc_ring_span
+	{
+	public:
+		using type = mpmc_ring_span<T>;
+		using size_type = std::size_t;
+		using value_type = T;
+		using pointer = T*;
+		using reference = T&;
+		using const_reference = const T&;
+		using cell_type = mpmc_ring_cell<T>;
+
+		// Resets the sequence number of every cell in [begin, end).
+		template <class ContiguousIterator>
+		mpmc_ring_span(ContiguousIterator begin, ContiguousIterator end) noexcept;
+
+		mpmc_ring_span(const mpmc_ring_span&) = delete;
+		mpmc_ring_span& operator=(const mpmc_ring_span&) = delete;
+
+		// empty() and size() are only a snapshot while other threads are active.
+		bool empty() const noexcept;
+		size_type size() const noexcept;
+		size_type capacity() const noexcept;
+
+		template<bool b = true, typename = std::enable_if_t<b && std::is_copy_assignable<T>::value>>
+		bool try_push_back(const value_type& from_value) noexcept(std::is_nothrow_copy_assignable<T>::value);
+		template<bool b = true, typename = std::enable_if_t<b && std::is_move_assignable<T>::value>>
+		bool try_push_back(value_type&& from_value) noexcept(std::is_nothrow_move_assignable<T>::value);
+		template<class... FromType>
+		bool try_emplace_back(FromType&&... from_value) noexcept(std::is_nothrow_constructible<T, FromType...>::value && std::is_nothrow_move_assignable<T>::value);
+
+		template<bool b = true, typename = std::enable_if_t<b && std::is_move_assignable<T>::value>>
+		bool try_pop_front(value_type& to_value) noexcept(std::is_nothrow_move_assignable<T>::value);
+
+		// Example implementation
+	private:
+		template<class Assign>
+		bool try_produce(Assign&& assign);
+
+		cell_type* m_cells;
+		size_type m_mask;
+
+		alignas(SG14_RING_CACHE_LINE_SIZE) std::atomic<size_type> m_tail;
+		alignas(SG14_RING_CACHE_LINE_SIZE) std::atomic<size_type> m_head;
+	};
 } // namespace sg14
 
 // Sample implementation
@@ -190,13 +638,49 @@ T sg14::copy_popper<T>::operator()(T& t) const
 	return old;
 }
 
-template<typename T, class Popper>
-template<class ContiguousIterator>
-sg14::ring_span<T, Popper>::ring_span(ContiguousIterator begin, ContiguousIterator end, Popper p) noexcept
-	: m_data(&*begin)
-	, m_size(0)
-	, m_capacity(end - begin)
-	, m_front_idx(0)
+template <typename T>
+sg14::ring_segment<T>::ring_segment(pointer data, size_type size) noexcept
+	: m_data(data)
+	, m_size(size)
+{}
+
+template <typename T>
+typename sg14::ring_segment<T>::pointer sg14::ring_segment<T>::data() const noexcept
+{
+	return m_data;
+}
+
+template <typename T>
+typename sg14::ring_segment<T>::size_type sg14::ring_segment<T>::size() const noexcept
+{
+	return m_size;
+}
+
+template <typename T>
+bool sg14::ring_segment<T>::empty() const noexcept
+{
+	return m_size == 0;
+}
+
+template <typename T>
+typename sg14::ring_segment<T>::pointer sg14::ring_segment<T>::begin() const noexcept
+{
+	return m_data;
+}
+
+template <typename T>
+typename sg14::ring_segment<T>::pointer sg14::ring_segment<T>::end() const noexcept
+{
+	return m_data + m_size;
+}
+
+template<typename T, class Popper>
+template<class ContiguousIterator>
+sg14::ring_span<T, Popper>::ring_span(ContiguousIterator begin, ContiguousIterator end, Popper p) noexcept
+	: m_data(&*begin)
+	, m_size(0)
+	, m_capacity(end - begin)
+	, m_front_idx(0)
 	, m_popper(std::move(p))
 {}
 
@@ -364,6 +848,108 @@ auto sg14::ring_span<T, Popper>::pop_front()
 	return m_popper(m_data[old_front_idx]);
 }
 
+template<typename T, class Popper>
+template<class InputIterator, typename>
+void sg14::ring_span<T, Popper>::push_back(InputIterator first, InputIterator last)
+{
+	push_back_range(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+
+template<typename T, class Popper>
+template<class InputIterator>
+void sg14::ring_span<T, Popper>::push_back_range(InputIterator first, InputIterator last, std::input_iterator_tag)
+{
+	for (; first != last; ++first)
+	{
+		m_data[back_idx()] = *first;
+		increase_size();
+	}
+}
+
+template<typename T, class Popper>
+template<class RandomAccessIterator>
+void sg14::ring_span<T, Popper>::push_back_range(RandomAccessIterator first, RandomAccessIterator last, std::random_access_iterator_tag)
+{
+	auto n = static_cast<size_type>(last - first);
+	if (n > m_capacity)
+	{
+		// Everything but the last m_capacity elements would be overwritten anyway.
+		first += (n - m_capacity);
+		n = m_capacity;
+	}
+	size_type write_idx = back_idx();
+	size_type first_run = std::min(n, m_capacity - write_idx);
+	std::copy(first, first + first_run, m_data + write_idx);
+	std::copy(first + first_run, first + n, m_data);
+
+	size_type overflow = (m_size + n > m_capacity) ? (m_size + n - m_capacity) : 0;
+	m_front_idx = (m_front_idx + overflow) % m_capacity;
+	m_size += n - overflow;
+}
+
+template<typename T, class Popper>
+template<class OutputIterator>
+OutputIterator sg14::ring_span<T, Popper>::pop_front_n(OutputIterator out, size_type n)
+{
+	assert(n <= m_size);
+	auto segments = split<segment>(m_front_idx, n);
+	for (T& t : segments.first)
+	{
+		*out = m_popper(t);
+		++out;
+	}
+	for (T& t : segments.second)
+	{
+		*out = m_popper(t);
+		++out;
+	}
+	drop_front(n);
+	return out;
+}
+
+template<typename T, class Popper>
+typename sg14::ring_span<T, Popper>::segment_pair sg14::ring_span<T, Popper>::readable_segments() noexcept
+{
+	return split<segment>(m_front_idx, m_size);
+}
+
+template<typename T, class Popper>
+typename sg14::ring_span<T, Popper>::const_segment_pair sg14::ring_span<T, Popper>::readable_segments() const noexcept
+{
+	return split<const_segment>(m_front_idx, m_size);
+}
+
+template<typename T, class Popper>
+typename sg14::ring_span<T, Popper>::segment_pair sg14::ring_span<T, Popper>::writable_segments() noexcept
+{
+	return split<segment>(back_idx(), m_capacity - m_size);
+}
+
+template<typename T, class Popper>
+void sg14::ring_span<T, Popper>::commit_back(size_type n) noexcept
+{
+	assert(n <= m_capacity - m_size);
+	m_size += n;
+}
+
+template<typename T, class Popper>
+void sg14::ring_span<T, Popper>::drop_front(size_type n) noexcept
+{
+	assert(n <= m_size);
+	m_front_idx = (m_front_idx + n) % m_capacity;
+	m_size -= n;
+}
+
+template<typename T, class Popper>
+template<class Segment>
+std::pair<Segment, Segment> sg14::ring_span<T, Popper>::split(size_type idx, size_type count) const noexcept
+{
+	size_type first_run = std::min(count, m_capacity - idx);
+	return std::pair<Segment, Segment>(
+		Segment(m_data + idx, first_run),
+		Segment(m_data, count - first_run));
+}
+
 template<typename T, class Popper>
 void sg14::ring_span<T, Popper>::swap(sg14::ring_span<T, Popper>& rhs) noexcept//(std::is_nothrow_swappable<Popper>::value)
 {
@@ -514,11 +1100,1101 @@ sg14::ring_iterator<Ring, is_const>::ring_iterator(typename sg14::ring_iterator<
 	, m_rv(rv)
 {}
 
+template<typename T, class Popper>
+template<class ContiguousIterator>
+sg14::pow2_ring_span<T, Popper>::pow2_ring_span(ContiguousIterator begin, ContiguousIterator end, Popper p) noexcept
+	: m_data(&*begin)
+	, m_mask(static_cast<size_type>(end - begin) - 1)
+	, m_head(0)
+	, m_tail(0)
+	, m_popper(std::move(p))
+{
+	assert(end != begin && ((m_mask + 1) & m_mask) == 0);
+}
 
-namespace sg14
+template<typename T, class Popper>
+template<class ContiguousIterator>
+sg14::pow2_ring_span<T, Popper>::pow2_ring_span(ContiguousIterator begin, ContiguousIterator end, ContiguousIterator first, size_type size, Popper p) noexcept
+	: m_data(&*begin)
+	, m_mask(static_cast<size_type>(end - begin) - 1)
+	, m_head(first - begin)
+	, m_tail((first - begin) + size)
+	, m_popper(std::move(p))
 {
-	template<typename T, class Popper>
-	void swap(ring_span<T, Popper>& a, ring_span<T, Popper>& b) noexcept
+	assert(end != begin && ((m_mask + 1) & m_mask) == 0);
+}
+
+template<typename T, class Popper>
+bool sg14::pow2_ring_span<T, Popper>::empty() const noexcept
+{
+	return m_tail == m_head;
+}
+
+template<typename T, class Popper>
+bool sg14::pow2_ring_span<T, Popper>::full() const noexcept
+{
+	return m_tail - m_head == capacity();
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::size_type sg14::pow2_ring_span<T, Popper>::size() const noexcept
+{
+	return m_tail - m_head;
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::size_type sg14::pow2_ring_span<T, Popper>::capacity() const noexcept
+{
+	return m_mask + 1;
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::reference sg14::pow2_ring_span<T, Popper>::front() noexcept
+{
+	return at(m_head);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_reference sg14::pow2_ring_span<T, Popper>::front() const noexcept
+{
+	return at(m_head);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::reference sg14::pow2_ring_span<T, Popper>::back() noexcept
+{
+	return at(m_tail - 1);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_reference sg14::pow2_ring_span<T, Popper>::back() const noexcept
+{
+	return at(m_tail - 1);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::iterator sg14::pow2_ring_span<T, Popper>::begin() noexcept
+{
+	return iterator(m_head, this);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_iterator sg14::pow2_ring_span<T, Popper>::begin() const noexcept
+{
+	return const_iterator(m_head, this);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::iterator sg14::pow2_ring_span<T, Popper>::end() noexcept
+{
+	return iterator(m_tail, this);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_iterator sg14::pow2_ring_span<T, Popper>::end() const noexcept
+{
+	return const_iterator(m_tail, this);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_iterator sg14::pow2_ring_span<T, Popper>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::reverse_iterator sg14::pow2_ring_span<T, Popper>::rbegin() noexcept
+{
+	return reverse_iterator(end());
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_reverse_iterator sg14::pow2_ring_span<T, Popper>::rbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_reverse_iterator sg14::pow2_ring_span<T, Popper>::crbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_iterator sg14::pow2_ring_span<T, Popper>::cend() const noexcept
+{
+	return end();
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::reverse_iterator sg14::pow2_ring_span<T, Popper>::rend() noexcept
+{
+	return reverse_iterator(begin());
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_reverse_iterator sg14::pow2_ring_span<T, Popper>::rend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_reverse_iterator sg14::pow2_ring_span<T, Popper>::crend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename T, class Popper>
+template<bool b, typename>
+void sg14::pow2_ring_span<T, Popper>::push_back(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value)
+{
+	m_data[m_tail & m_mask] = value;
+	increase_size();
+}
+
+template<typename T, class Popper>
+template<bool b, typename>
+void sg14::pow2_ring_span<T, Popper>::push_back(T&& value) noexcept(std::is_nothrow_move_assignable<T>::value)
+{
+	m_data[m_tail & m_mask] = std::move(value);
+	increase_size();
+}
+
+template<typename T, class Popper>
+template<class... FromType>
+void sg14::pow2_ring_span<T, Popper>::emplace_back(FromType&&... from_value) noexcept(std::is_nothrow_constructible<T, FromType...>::value && std::is_nothrow_move_assignable<T>::value)
+{
+	m_data[m_tail & m_mask] = T(std::forward<FromType>(from_value)...);
+	increase_size();
+}
+
+template<typename T, class Popper>
+auto sg14::pow2_ring_span<T, Popper>::pop_front()
+{
+	assert(m_tail != m_head);
+	return m_popper(m_data[m_head++ & m_mask]);
+}
+
+template<typename T, class Popper>
+void sg14::pow2_ring_span<T, Popper>::swap(sg14::pow2_ring_span<T, Popper>& rhs) noexcept//(std::is_nothrow_swappable<Popper>::value)
+{
+	using std::swap;
+	swap(m_data, rhs.m_data);
+	swap(m_mask, rhs.m_mask);
+	swap(m_head, rhs.m_head);
+	swap(m_tail, rhs.m_tail);
+	swap(m_popper, rhs.m_popper);
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::reference sg14::pow2_ring_span<T, Popper>::at(size_type i) noexcept
+{
+	return m_data[i & m_mask];
+}
+
+template<typename T, class Popper>
+typename sg14::pow2_ring_span<T, Popper>::const_reference sg14::pow2_ring_span<T, Popper>::at(size_type i) const noexcept
+{
+	return m_data[i & m_mask];
+}
+
+template<typename T, class Popper>
+void sg14::pow2_ring_span<T, Popper>::increase_size() noexcept
+{
+	if (++m_tail - m_head > m_mask + 1)
+	{
+		++m_head;
+	}
+}
+
+template<typename T, std::size_t N>
+sg14::static_ring<T, N>::static_ring() noexcept
+	: m_size(0)
+	, m_front_idx(0)
+{}
+
+template<typename T, std::size_t N>
+sg14::static_ring<T, N>::static_ring(const static_ring& rhs)
+	: static_ring()
+{
+	for (const T& t : rhs)
+	{
+		emplace_back(t);
+	}
+}
+
+template<typename T, std::size_t N>
+sg14::static_ring<T, N>::static_ring(static_ring&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+	: static_ring()
+{
+	for (T& t : rhs)
+	{
+		emplace_back(std::move(t));
+	}
+}
+
+template<typename T, std::size_t N>
+sg14::static_ring<T, N>& sg14::static_ring<T, N>::operator=(const static_ring& rhs)
+{
+	if (this != &rhs)
+	{
+		clear();
+		for (const T& t : rhs)
+		{
+			emplace_back(t);
+		}
+	}
+	return *this;
+}
+
+template<typename T, std::size_t N>
+sg14::static_ring<T, N>& sg14::static_ring<T, N>::operator=(static_ring&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+{
+	if (this != &rhs)
+	{
+		clear();
+		for (T& t : rhs)
+		{
+			emplace_back(std::move(t));
+		}
+	}
+	return *this;
+}
+
+template<typename T, std::size_t N>
+sg14::static_ring<T, N>::~static_ring()
+{
+	clear();
+}
+
+template<typename T, std::size_t N>
+bool sg14::static_ring<T, N>::empty() const noexcept
+{
+	return m_size == 0;
+}
+
+template<typename T, std::size_t N>
+bool sg14::static_ring<T, N>::full() const noexcept
+{
+	return m_size == N;
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::size_type sg14::static_ring<T, N>::size() const noexcept
+{
+	return m_size;
+}
+
+template<typename T, std::size_t N>
+constexpr typename sg14::static_ring<T, N>::size_type sg14::static_ring<T, N>::capacity() noexcept
+{
+	return N;
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::reference sg14::static_ring<T, N>::front() noexcept
+{
+	return at(m_front_idx);
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_reference sg14::static_ring<T, N>::front() const noexcept
+{
+	return at(m_front_idx);
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::reference sg14::static_ring<T, N>::back() noexcept
+{
+	return at(m_front_idx + m_size - 1);
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_reference sg14::static_ring<T, N>::back() const noexcept
+{
+	return at(m_front_idx + m_size - 1);
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::iterator sg14::static_ring<T, N>::begin() noexcept
+{
+	return iterator(m_front_idx, this);
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_iterator sg14::static_ring<T, N>::begin() const noexcept
+{
+	return const_iterator(m_front_idx, this);
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::iterator sg14::static_ring<T, N>::end() noexcept
+{
+	return iterator(m_front_idx + m_size, this);
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_iterator sg14::static_ring<T, N>::end() const noexcept
+{
+	return const_iterator(m_front_idx + m_size, this);
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_iterator sg14::static_ring<T, N>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::reverse_iterator sg14::static_ring<T, N>::rbegin() noexcept
+{
+	return reverse_iterator(end());
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_reverse_iterator sg14::static_ring<T, N>::rbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_reverse_iterator sg14::static_ring<T, N>::crbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_iterator sg14::static_ring<T, N>::cend() const noexcept
+{
+	return end();
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::reverse_iterator sg14::static_ring<T, N>::rend() noexcept
+{
+	return reverse_iterator(begin());
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_reverse_iterator sg14::static_ring<T, N>::rend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_reverse_iterator sg14::static_ring<T, N>::crend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename T, std::size_t N>
+void sg14::static_ring<T, N>::push_back(const T& value)
+{
+	emplace_back(value);
+}
+
+template<typename T, std::size_t N>
+void sg14::static_ring<T, N>::push_back(T&& value)
+{
+	emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t N>
+template<class... FromType>
+typename sg14::static_ring<T, N>::reference sg14::static_ring<T, N>::emplace_back(FromType&&... from_value)
+{
+	if (m_size == N)
+	{
+		// The arguments may refer to the element we are about to evict.
+		T value(std::forward<FromType>(from_value)...);
+		destroy_front();
+		::new (slot(m_front_idx + m_size)) T(std::move(value));
+	}
+	else
+	{
+		::new (slot(m_front_idx + m_size)) T(std::forward<FromType>(from_value)...);
+	}
+	++m_size;
+	return back();
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::value_type sg14::static_ring<T, N>::pop_front()
+{
+	assert(m_size != 0);
+	T result(std::move(front()));
+	destroy_front();
+	return result;
+}
+
+template<typename T, std::size_t N>
+void sg14::static_ring<T, N>::clear() noexcept
+{
+	while (m_size != 0)
+	{
+		destroy_front();
+	}
+	m_front_idx = 0;
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::reference sg14::static_ring<T, N>::at(size_type i) noexcept
+{
+	return *static_cast<T*>(slot(i));
+}
+
+template<typename T, std::size_t N>
+typename sg14::static_ring<T, N>::const_reference sg14::static_ring<T, N>::at(size_type i) const noexcept
+{
+	return *static_cast<const T*>(static_cast<const void*>(&m_storage[i % N]));
+}
+
+template<typename T, std::size_t N>
+void* sg14::static_ring<T, N>::slot(size_type i) noexcept
+{
+	return &m_storage[i % N];
+}
+
+template<typename T, std::size_t N>
+void sg14::static_ring<T, N>::destroy_front() noexcept
+{
+	front().~T();
+	m_front_idx = (m_front_idx + 1) % N;
+	--m_size;
+}
+
+template<typename T, class Allocator>
+sg14::dynamic_ring<T, Allocator>::dynamic_ring() noexcept(noexcept(Allocator()))
+	: dynamic_ring(Allocator())
+{}
+
+template<typename T, class Allocator>
+sg14::dynamic_ring<T, Allocator>::dynamic_ring(const Allocator& alloc) noexcept
+	: m_alloc(alloc)
+	, m_data(nullptr)
+	, m_capacity(0)
+	, m_size(0)
+	, m_front_idx(0)
+{}
+
+template<typename T, class Allocator>
+sg14::dynamic_ring<T, Allocator>::dynamic_ring(const dynamic_ring& rhs)
+	: dynamic_ring(alloc_traits::select_on_container_copy_construction(rhs.m_alloc))
+{
+	reserve(rhs.m_size);
+	for (const T& t : rhs)
+	{
+		emplace_back(t);
+	}
+}
+
+template<typename T, class Allocator>
+sg14::dynamic_ring<T, Allocator>::dynamic_ring(dynamic_ring&& rhs) noexcept
+	: m_alloc(std::move(rhs.m_alloc))
+	, m_data(rhs.m_data)
+	, m_capacity(rhs.m_capacity)
+	, m_size(rhs.m_size)
+	, m_front_idx(rhs.m_front_idx)
+{
+	rhs.m_data = nullptr;
+	rhs.m_capacity = 0;
+	rhs.m_size = 0;
+	rhs.m_front_idx = 0;
+}
+
+template<typename T, class Allocator>
+sg14::dynamic_ring<T, Allocator>& sg14::dynamic_ring<T, Allocator>::operator=(const dynamic_ring& rhs)
+{
+	if (this != &rhs)
+	{
+		if (alloc_traits::propagate_on_container_copy_assignment::value && m_alloc != rhs.m_alloc)
+		{
+			release();
+		}
+		clear();
+		if (alloc_traits::propagate_on_container_copy_assignment::value)
+		{
+			m_alloc = rhs.m_alloc;
+		}
+		reserve(rhs.m_size);
+		for (const T& t : rhs)
+		{
+			emplace_back(t);
+		}
+	}
+	return *this;
+}
+
+template<typename T, class Allocator>
+sg14::dynamic_ring<T, Allocator>& sg14::dynamic_ring<T, Allocator>::operator=(dynamic_ring&& rhs)
+{
+	if (this == &rhs)
+	{
+		return *this;
+	}
+	if (alloc_traits::propagate_on_container_move_assignment::value || m_alloc == rhs.m_alloc)
+	{
+		release();
+		if (alloc_traits::propagate_on_container_move_assignment::value)
+		{
+			m_alloc = std::move(rhs.m_alloc);
+		}
+		m_data = rhs.m_data;
+		m_capacity = rhs.m_capacity;
+		m_size = rhs.m_size;
+		m_front_idx = rhs.m_front_idx;
+		rhs.m_data = nullptr;
+		rhs.m_capacity = 0;
+		rhs.m_size = 0;
+		rhs.m_front_idx = 0;
+	}
+	else
+	{
+		// Unequal allocators that do not propagate: we cannot steal the buffer.
+		clear();
+		reserve(rhs.m_size);
+		for (T& t : rhs)
+		{
+			emplace_back(std::move(t));
+		}
+		rhs.clear();
+	}
+	return *this;
+}
+
+template<typename T, class Allocator>
+sg14::dynamic_ring<T, Allocator>::~dynamic_ring()
+{
+	release();
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::allocator_type sg14::dynamic_ring<T, Allocator>::get_allocator() const noexcept
+{
+	return m_alloc;
+}
+
+template<typename T, class Allocator>
+bool sg14::dynamic_ring<T, Allocator>::empty() const noexcept
+{
+	return m_size == 0;
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::size_type sg14::dynamic_ring<T, Allocator>::size() const noexcept
+{
+	return m_size;
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::size_type sg14::dynamic_ring<T, Allocator>::capacity() const noexcept
+{
+	return m_capacity;
+}
+
+template<typename T, class Allocator>
+void sg14::dynamic_ring<T, Allocator>::reserve(size_type n)
+{
+	if (n <= m_capacity)
+	{
+		return;
+	}
+	size_type new_capacity = 1;
+	while (new_capacity < n)
+	{
+		new_capacity *= 2;
+	}
+	T* buffer = alloc_traits::allocate(m_alloc, new_capacity);
+	try
+	{
+		relocate_into(buffer);
+	}
+	catch (...)
+	{
+		alloc_traits::deallocate(m_alloc, buffer, new_capacity);
+		throw;
+	}
+	adopt(buffer, new_capacity);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::reference sg14::dynamic_ring<T, Allocator>::front() noexcept
+{
+	return at(m_front_idx);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_reference sg14::dynamic_ring<T, Allocator>::front() const noexcept
+{
+	return at(m_front_idx);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::reference sg14::dynamic_ring<T, Allocator>::back() noexcept
+{
+	return at(m_front_idx + m_size - 1);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_reference sg14::dynamic_ring<T, Allocator>::back() const noexcept
+{
+	return at(m_front_idx + m_size - 1);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::iterator sg14::dynamic_ring<T, Allocator>::begin() noexcept
+{
+	return iterator(m_front_idx, this);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_iterator sg14::dynamic_ring<T, Allocator>::begin() const noexcept
+{
+	return const_iterator(m_front_idx, this);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::iterator sg14::dynamic_ring<T, Allocator>::end() noexcept
+{
+	return iterator(m_front_idx + m_size, this);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_iterator sg14::dynamic_ring<T, Allocator>::end() const noexcept
+{
+	return const_iterator(m_front_idx + m_size, this);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_iterator sg14::dynamic_ring<T, Allocator>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::reverse_iterator sg14::dynamic_ring<T, Allocator>::rbegin() noexcept
+{
+	return reverse_iterator(end());
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_reverse_iterator sg14::dynamic_ring<T, Allocator>::rbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_reverse_iterator sg14::dynamic_ring<T, Allocator>::crbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_iterator sg14::dynamic_ring<T, Allocator>::cend() const noexcept
+{
+	return end();
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::reverse_iterator sg14::dynamic_ring<T, Allocator>::rend() noexcept
+{
+	return reverse_iterator(begin());
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_reverse_iterator sg14::dynamic_ring<T, Allocator>::rend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_reverse_iterator sg14::dynamic_ring<T, Allocator>::crend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename T, class Allocator>
+void sg14::dynamic_ring<T, Allocator>::push_back(const T& value)
+{
+	emplace_back(value);
+}
+
+template<typename T, class Allocator>
+void sg14::dynamic_ring<T, Allocator>::push_back(T&& value)
+{
+	emplace_back(std::move(value));
+}
+
+template<typename T, class Allocator>
+template<class... FromType>
+typename sg14::dynamic_ring<T, Allocator>::reference sg14::dynamic_ring<T, Allocator>::emplace_back(FromType&&... from_value)
+{
+	if (m_size != m_capacity)
+	{
+		alloc_traits::construct(m_alloc, &at(m_front_idx + m_size), std::forward<FromType>(from_value)...);
+		++m_size;
+		return back();
+	}
+
+	// Construct the new element first, since the arguments may refer to
+	// elements of this ring; then move the old elements in front of it.
+	size_type new_capacity = m_capacity ? (m_capacity * 2) : 1;
+	T* buffer = alloc_traits::allocate(m_alloc, new_capacity);
+	try
+	{
+		alloc_traits::construct(m_alloc, buffer + m_size, std::forward<FromType>(from_value)...);
+	}
+	catch (...)
+	{
+		alloc_traits::deallocate(m_alloc, buffer, new_capacity);
+		throw;
+	}
+	try
+	{
+		relocate_into(buffer);
+	}
+	catch (...)
+	{
+		alloc_traits::destroy(m_alloc, buffer + m_size);
+		alloc_traits::deallocate(m_alloc, buffer, new_capacity);
+		throw;
+	}
+	adopt(buffer, new_capacity);
+	++m_size;
+	return back();
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::value_type sg14::dynamic_ring<T, Allocator>::pop_front()
+{
+	assert(m_size != 0);
+	T result(std::move(front()));
+	alloc_traits::destroy(m_alloc, &front());
+	m_front_idx = (m_front_idx + 1) & (m_capacity - 1);
+	--m_size;
+	return result;
+}
+
+template<typename T, class Allocator>
+void sg14::dynamic_ring<T, Allocator>::clear() noexcept
+{
+	for (T& t : *this)
+	{
+		alloc_traits::destroy(m_alloc, &t);
+	}
+	m_size = 0;
+	m_front_idx = 0;
+}
+
+template<typename T, class Allocator>
+void sg14::dynamic_ring<T, Allocator>::swap(sg14::dynamic_ring<T, Allocator>& rhs) noexcept
+{
+	using std::swap;
+	if (alloc_traits::propagate_on_container_swap::value)
+	{
+		swap(m_alloc, rhs.m_alloc);
+	}
+	swap(m_data, rhs.m_data);
+	swap(m_capacity, rhs.m_capacity);
+	swap(m_size, rhs.m_size);
+	swap(m_front_idx, rhs.m_front_idx);
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::reference sg14::dynamic_ring<T, Allocator>::at(size_type i) noexcept
+{
+	return m_data[i & (m_capacity - 1)];
+}
+
+template<typename T, class Allocator>
+typename sg14::dynamic_ring<T, Allocator>::const_reference sg14::dynamic_ring<T, Allocator>::at(size_type i) const noexcept
+{
+	return m_data[i & (m_capacity - 1)];
+}
+
+template<typename T, class Allocator>
+void sg14::dynamic_ring<T, Allocator>::relocate_into(T* buffer)
+{
+	size_type constructed = 0;
+	try
+	{
+		for (T& t : *this)
+		{
+			alloc_traits::construct(m_alloc, buffer + constructed, std::move_if_noexcept(t));
+			++constructed;
+		}
+	}
+	catch (...)
+	{
+		while (constructed != 0)
+		{
+			alloc_traits::destroy(m_alloc, buffer + --constructed);
+		}
+		throw;
+	}
+}
+
+template<typename T, class Allocator>
+void sg14::dynamic_ring<T, Allocator>::adopt(T* buffer, size_type new_capacity) noexcept
+{
+	size_type size = m_size;
+	release();
+	m_data = buffer;
+	m_capacity = new_capacity;
+	m_size = size;
+	m_front_idx = 0;
+}
+
+template<typename T, class Allocator>
+void sg14::dynamic_ring<T, Allocator>::release() noexcept
+{
+	clear();
+	if (m_data != nullptr)
+	{
+		alloc_traits::deallocate(m_alloc, m_data, m_capacity);
+		m_data = nullptr;
+		m_capacity = 0;
+	}
+}
+
+template<typename T>
+template<class ContiguousIterator>
+sg14::spsc_ring_span<T>::spsc_ring_span(ContiguousIterator begin, ContiguousIterator end) noexcept
+	: m_data(&*begin)
+	, m_mask(static_cast<size_type>(end - begin) - 1)
+	, m_tail(0)
+	, m_cached_head(0)
+	, m_head(0)
+	, m_cached_tail(0)
+{
+	assert(end != begin && ((m_mask + 1) & m_mask) == 0);
+}
+
+template<typename T>
+bool sg14::spsc_ring_span<T>::empty() const noexcept
+{
+	return size() == 0;
+}
+
+template<typename T>
+bool sg14::spsc_ring_span<T>::full() const noexcept
+{
+	return size() == capacity();
+}
+
+template<typename T>
+typename sg14::spsc_ring_span<T>::size_type sg14::spsc_ring_span<T>::size() const noexcept
+{
+	size_type head = m_head.load(std::memory_order_acquire);
+	size_type tail = m_tail.load(std::memory_order_acquire);
+	return tail - head;
+}
+
+template<typename T>
+typename sg14::spsc_ring_span<T>::size_type sg14::spsc_ring_span<T>::capacity() const noexcept
+{
+	return m_mask + 1;
+}
+
+template<typename T>
+template<bool b, typename>
+bool sg14::spsc_ring_span<T>::try_push_back(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value)
+{
+	return try_produce([&](T& slot) { slot = value; });
+}
+
+template<typename T>
+template<bool b, typename>
+bool sg14::spsc_ring_span<T>::try_push_back(T&& value) noexcept(std::is_nothrow_move_assignable<T>::value)
+{
+	return try_produce([&](T& slot) { slot = std::move(value); });
+}
+
+template<typename T>
+template<class... FromType>
+bool sg14::spsc_ring_span<T>::try_emplace_back(FromType&&... from_value) noexcept(std::is_nothrow_constructible<T, FromType...>::value && std::is_nothrow_move_assignable<T>::value)
+{
+	return try_produce([&](T& slot) { slot = T(std::forward<FromType>(from_value)...); });
+}
+
+template<typename T>
+template<class Assign>
+bool sg14::spsc_ring_span<T>::try_produce(Assign&& assign)
+{
+	size_type tail = m_tail.load(std::memory_order_relaxed);
+	if (tail - m_cached_head > m_mask)
+	{
+		// Only touch the consumer's cache line when our cached view says we are full.
+		m_cached_head = m_head.load(std::memory_order_acquire);
+		if (tail - m_cached_head > m_mask)
+		{
+			return false;
+		}
+	}
+	assign(m_data[tail & m_mask]);
+	m_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T>
+template<bool b, typename>
+bool sg14::spsc_ring_span<T>::try_pop_front(T& to_value) noexcept(std::is_nothrow_move_assignable<T>::value)
+{
+	size_type head = m_head.load(std::memory_order_relaxed);
+	if (head == m_cached_tail)
+	{
+		// Only touch the producer's cache line when our cached view says we are empty.
+		m_cached_tail = m_tail.load(std::memory_order_acquire);
+		if (head == m_cached_tail)
+		{
+			return false;
+		}
+	}
+	to_value = std::move(m_data[head & m_mask]);
+	m_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T>
+template<class ContiguousIterator>
+sg14::mpmc_ring_span<T>::mpmc_ring_span(ContiguousIterator begin, ContiguousIterator end) noexcept
+	: m_cells(&*begin)
+	, m_mask(static_cast<size_type>(end - begin) - 1)
+	, m_tail(0)
+	, m_head(0)
+{
+	assert(end != begin && ((m_mask + 1) & m_mask) == 0);
+	for (size_type i = 0; i <= m_mask; ++i)
+	{
+		m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template<typename T>
+bool sg14::mpmc_ring_span<T>::empty() const noexcept
+{
+	return size() == 0;
+}
+
+template<typename T>
+typename sg14::mpmc_ring_span<T>::size_type sg14::mpmc_ring_span<T>::size() const noexcept
+{
+	size_type head = m_head.load(std::memory_order_acquire);
+	size_type tail = m_tail.load(std::memory_order_acquire);
+	// A consumer may have claimed a slot that we observe the producer of
+	// only later; never report a negative size.
+	return (tail > head) ? (tail - head) : 0;
+}
+
+template<typename T>
+typename sg14::mpmc_ring_span<T>::size_type sg14::mpmc_ring_span<T>::capacity() const noexcept
+{
+	return m_mask + 1;
+}
+
+template<typename T>
+template<bool b, typename>
+bool sg14::mpmc_ring_span<T>::try_push_back(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value)
+{
+	return try_produce([&](T& slot) { slot = value; });
+}
+
+template<typename T>
+template<bool b, typename>
+bool sg14::mpmc_ring_span<T>::try_push_back(T&& value) noexcept(std::is_nothrow_move_assignable<T>::value)
+{
+	return try_produce([&](T& slot) { slot = std::move(value); });
+}
+
+template<typename T>
+template<class... FromType>
+bool sg14::mpmc_ring_span<T>::try_emplace_back(FromType&&... from_value) noexcept(std::is_nothrow_constructible<T, FromType...>::value && std::is_nothrow_move_assignable<T>::value)
+{
+	return try_produce([&](T& slot) { slot = T(std::forward<FromType>(from_value)...); });
+}
+
+template<typename T>
+template<class Assign>
+bool sg14::mpmc_ring_span<T>::try_produce(Assign&& assign)
+{
+	size_type pos = m_tail.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		cell_type& cell = m_cells[pos & m_mask];
+		size_type seq = cell.m_sequence.load(std::memory_order_acquire);
+		auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+		if (diff == 0)
+		{
+			// The cell is free for lap "pos"; try to claim it.
+			if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				assign(cell.m_value);
+				cell.m_sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+		{
+			// The cell still holds an element from the previous lap: full.
+			return false;
+		}
+		else
+		{
+			// Another producer got here first.
+			pos = m_tail.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template<typename T>
+template<bool b, typename>
+bool sg14::mpmc_ring_span<T>::try_pop_front(T& to_value) noexcept(std::is_nothrow_move_assignable<T>::value)
+{
+	size_type pos = m_head.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		cell_type& cell = m_cells[pos & m_mask];
+		size_type seq = cell.m_sequence.load(std::memory_order_acquire);
+		auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+		if (diff == 0)
+		{
+			if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				to_value = std::move(cell.m_value);
+				// Hand the cell back to producers for the next lap.
+				cell.m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+		{
+			// No producer has published this cell yet: empty.
+			return false;
+		}
+		else
+		{
+			pos = m_head.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+
+namespace sg14
+{
+	template<typename T, class Popper>
+	void swap(ring_span<T, Popper>& a, ring_span<T, Popper>& b) noexcept
+	{
+		a.swap(b);
+	}
+
+	template<typename T, class Popper>
+	void swap(pow2_ring_span<T, Popper>& a, pow2_ring_span<T, Popper>& b) noexcept
+	{
+		a.swap(b);
+	}
+
+	template<typename T, class Allocator>
+	void swap(dynamic_ring<T, Allocator>& a, dynamic_ring<T, Allocator>& b) noexcept
 	{
 		a.swap(b);
 	}
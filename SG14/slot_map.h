@@ -26,15 +26,35 @@
 
 #pragma once
 
+#include "slot_map_key.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <system_error>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
 #ifndef SLOT_MAP_THROW_EXCEPTION
 #include <stdexcept>
 #define SLOT_MAP_THROW_EXCEPTION(type, ...) throw type(__VA_ARGS__)
 #endif
 
+#ifndef SG14_CACHE_LINE_SIZE
+#define SG14_CACHE_LINE_SIZE 64
+#endif
+
 namespace stdext {
 
 namespace slot_map_detail {
@@ -57,26 +77,650 @@ inline void reserve_if_possible(Ctr& ctr, const SizeType& n)
     slot_map_detail::reserve_if_possible(ctr, n, priority_tag<1>{});
 }
 
+template<class It>
+using is_random_access_iterator = std::is_convertible<
+    typename std::iterator_traits<It>::iterator_category,
+    std::random_access_iterator_tag
+>;
+
+inline void prefetch(const void *p)
+{
+#if defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
+// Prefetching needs a real address; proxy references (std::vector<bool>) get none.
+template<class It, std::enable_if_t<std::is_lvalue_reference<typename std::iterator_traits<It>::reference>::value, int> = 0>
+inline void prefetch_element(const It& it) { slot_map_detail::prefetch(std::addressof(*it)); }
+
+template<class It, std::enable_if_t<!std::is_lvalue_reference<typename std::iterator_traits<It>::reference>::value, int> = 0>
+inline void prefetch_element(const It&) {}
+
+// Calls g(first, last, index) for each maximal contiguous run of the
+// elements [a, b) of ctr, where index is the position of first in ctr.
+// Containers with data() form a single run, chunked_vector one run per
+// chunk; other containers pass their own iterators.
+template<class Ctr, class G>
+inline auto for_each_run(Ctr& ctr, size_t a, size_t b, G& g, priority_tag<2>) -> decltype(void(ctr.data()))
+{
+    auto first = ctr.data() + a;
+    g(first, first + (b - a), a);
+}
+
+template<class Ctr, class G>
+inline auto for_each_run(Ctr& ctr, size_t a, size_t b, G& g, priority_tag<1>) -> decltype(void(ctr.segment_begin(0)))
+{
+    while (a != b) {
+        size_t s = a / Ctr::chunk_size;
+        size_t run_end = (s + 1) * Ctr::chunk_size;
+        if (run_end > b) {
+            run_end = b;
+        }
+        auto first = ctr.segment_begin(s) + (a % Ctr::chunk_size);
+        g(first, first + (run_end - a), a);
+        a = run_end;
+    }
+}
+
+template<class Ctr, class G>
+inline void for_each_run(Ctr& ctr, size_t a, size_t b, G& g, priority_tag<0>)
+{
+    auto first = std::next(ctr.begin(), a);
+    g(first, std::next(first, b - a), a);
+}
+
+// The position of the highest set bit of n, which must be non-zero.
+inline unsigned highest_bit(std::uint64_t n)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(63 - __builtin_clzll(n));
+#else
+    unsigned result = 0;
+    while (n >>= 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+// Returns a function from a position in ctr to an iterator to it, which
+// takes O(1) time even if ctr's iterators are not random-access.
+template<class Ctr>
+inline auto index_container(Ctr& ctr, std::true_type)
+{
+    auto first = ctr.begin();
+    return [first](size_t i) { return std::next(first, i); };
+}
+
+template<class Ctr>
+inline auto index_container(Ctr& ctr, std::false_type)
+{
+    std::vector<decltype(ctr.begin())> iters;
+    for (auto it = ctr.begin(); it != ctr.end(); ++it) {
+        iters.push_back(it);
+    }
+    return [iters = std::move(iters)](size_t i) { return iters[i]; };
+}
+
+template<class Ctr>
+inline auto index_container(Ctr& ctr)
+{
+    return slot_map_detail::index_container(ctr, is_random_access_iterator<decltype(ctr.begin())>{});
+}
+
+// Whether a U can be saved and restored as raw bytes. std::pair is not
+// trivially copyable, because of its assignment operator, but a pair of
+// trivially copyable members is still a plain pair of values.
+template<class U>
+struct is_snapshottable : std::is_trivially_copyable<U> {};
+
+template<class A, class B>
+struct is_snapshottable<std::pair<A, B>> : std::integral_constant<bool, is_snapshottable<A>::value && is_snapshottable<B>::value> {};
+
+// The binary snapshot format of slot_map, in native byte order: a header,
+// then the slots, reverse map and values as raw arrays, each starting at a
+// multiple of 64 bytes from the start of the snapshot.
+struct snapshot_header {
+    char magic[8];  // "SG14SMAP"
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint32_t key_size;
+    std::uint32_t index_size;
+    std::uint32_t value_size;
+    std::uint32_t value_align;
+    std::uint64_t size;
+    std::uint64_t slot_count;
+    std::uint64_t next_available_slot_index;
+    std::uint64_t last_available_slot_index;
+    std::uint64_t slots_offset;
+    std::uint64_t reverse_map_offset;
+    std::uint64_t values_offset;
+    std::uint64_t total_size;
+};
+
+constexpr std::uint32_t snapshot_version = 1;
+constexpr size_t snapshot_alignment = 64;
+
+inline std::uint64_t snapshot_round_up(std::uint64_t n) { return (n + snapshot_alignment - 1) & ~std::uint64_t(snapshot_alignment - 1); }
+
+template<class Key, class Index, class T>
+inline snapshot_header make_snapshot_header(size_t size, size_t slot_count, size_t next_available, size_t last_available)
+{
+    snapshot_header h = {};
+    std::memcpy(h.magic, "SG14SMAP", sizeof h.magic);
+    h.version = snapshot_version;
+    h.header_size = sizeof(snapshot_header);
+    h.key_size = sizeof(Key);
+    h.index_size = sizeof(Index);
+    h.value_size = sizeof(T);
+    h.value_align = alignof(T);
+    h.size = size;
+    h.slot_count = slot_count;
+    h.next_available_slot_index = next_available;
+    h.last_available_slot_index = last_available;
+    h.slots_offset = snapshot_round_up(sizeof(snapshot_header));
+    h.reverse_map_offset = snapshot_round_up(h.slots_offset + slot_count * sizeof(Key));
+    h.values_offset = snapshot_round_up(h.reverse_map_offset + size * sizeof(Index));
+    h.total_size = h.values_offset + size * sizeof(T);
+    return h;
+}
+
+// Reads and validates the header of the snapshot [data, data + size),
+// throwing std::invalid_argument if it was not written by a slot_map with
+// the same Key and T, or is truncated or inconsistent.
+template<class Key, class Index, class T>
+inline snapshot_header read_snapshot_header(const void *data, size_t size)
+{
+    snapshot_header h;
+    if (size < sizeof h) {
+        SLOT_MAP_THROW_EXCEPTION(std::invalid_argument, "snapshot is truncated");
+    }
+    std::memcpy(&h, data, sizeof h);
+    if (std::memcmp(h.magic, "SG14SMAP", sizeof h.magic) != 0 || h.version != snapshot_version || h.header_size != sizeof h) {
+        SLOT_MAP_THROW_EXCEPTION(std::invalid_argument, "not a slot_map snapshot");
+    }
+    if (h.key_size != sizeof(Key) || h.index_size != sizeof(Index) || h.value_size != sizeof(T) || h.value_align != alignof(T)) {
+        SLOT_MAP_THROW_EXCEPTION(std::invalid_argument, "snapshot has different key or value types");
+    }
+    snapshot_header expected = make_snapshot_header<Key, Index, T>(
+        static_cast<size_t>(h.size), static_cast<size_t>(h.slot_count),
+        static_cast<size_t>(h.next_available_slot_index), static_cast<size_t>(h.last_available_slot_index));
+    if (h.size > h.slot_count || h.slot_count > (std::uint64_t(1) << 48) ||
+        h.next_available_slot_index > h.slot_count || h.last_available_slot_index > h.slot_count || std::memcmp(&h, &expected, sizeof h) != 0 || h.total_size > size) {
+        SLOT_MAP_THROW_EXCEPTION(std::invalid_argument, "snapshot is corrupt or truncated");
+    }
+    return h;
+}
+
+// Checks the arrays of a snapshot whose header read_snapshot_header has
+// accepted, throwing std::invalid_argument unless every reverse map entry
+// names a slot that points back at its value, and the free list runs from
+// its first to its last slot through free slots only.
+// O(n) time complexity and O(1) additional space complexity.
+template<class Key, class Index>
+inline void validate_snapshot_arrays(const snapshot_header& h, const char *base)
+{
+    auto slot_target = [&](std::uint64_t i) {
+        std::aligned_storage_t<sizeof(Key), alignof(Key)> k;
+        std::memcpy(&k, base + h.slots_offset + i * sizeof(Key), sizeof(Key));
+        return static_cast<std::uint64_t>(slot_map_key_traits<Key>::get_index(*reinterpret_cast<const Key*>(&k)));
+    };
+    auto reverse_target = [&](std::uint64_t v) {
+        Index r;
+        std::memcpy(&r, base + h.reverse_map_offset + v * sizeof(Index), sizeof r);
+        return static_cast<std::uint64_t>(r);
+    };
+    for (std::uint64_t v = 0; v < h.size; ++v) {
+        std::uint64_t i = reverse_target(v);
+        if (i >= h.slot_count || slot_target(i) != v) {
+            SLOT_MAP_THROW_EXCEPTION(std::invalid_argument, "snapshot has an inconsistent reverse map");
+        }
+    }
+    if ((h.next_available_slot_index == h.slot_count) != (h.last_available_slot_index == h.slot_count)) {
+        SLOT_MAP_THROW_EXCEPTION(std::invalid_argument, "snapshot has a corrupt free list");
+    }
+    if (h.next_available_slot_index == h.slot_count) {
+        return;
+    }
+    // At most slot_count - size slots are free, which bounds a cyclic list.
+    std::uint64_t free_slots = h.slot_count - h.size;
+    for (std::uint64_t i = h.next_available_slot_index; ; i = slot_target(i)) {
+        std::uint64_t v = (i < h.slot_count) ? slot_target(i) : 0;
+        if (i >= h.slot_count || free_slots == 0 || (v < h.size && reverse_target(v) == i)) {
+            SLOT_MAP_THROW_EXCEPTION(std::invalid_argument, "snapshot has a corrupt free list");
+        }
+        --free_slots;
+        if (i == h.last_available_slot_index) {
+            break;
+        }
+    }
+}
+
+// Writes the elements [first, last) through write(pointer, bytes): as one
+// block if they are contiguous, element by element otherwise.
+template<class Writer, class U>
+inline void write_run(Writer& write, U *first, U *last, size_t)
+{
+    write(static_cast<const void*>(first), static_cast<size_t>(last - first) * sizeof(U));
+}
+
+template<class Writer, class It>
+inline void write_run(Writer& write, It first, It last, size_t)
+{
+    for (; first != last; ++first) {
+        write(static_cast<const void*>(std::addressof(*first)), sizeof(*first));
+    }
+}
+
+// Replaces the contents of ctr with [first, first + n).
+template<class Ctr, class U>
+inline auto assign_from(Ctr& ctr, const U *first, size_t n, priority_tag<1>) -> decltype(void(ctr.assign(first, first + n)))
+{
+    ctr.assign(first, first + n);
+}
+
+template<class Ctr, class U>
+inline void assign_from(Ctr& ctr, const U *first, size_t n, priority_tag<0>)
+{
+    ctr.clear();
+    reserve_if_possible(ctr, n);
+    for (size_t i = 0; i < n; ++i) {
+        ctr.emplace_back(first[i]);
+    }
+}
+
+// One worker's share of the chunk indices, [lo, hi), packed into a single
+// word so that the owner and thieves can claim chunks with one CAS.
+struct work_range {
+    static constexpr std::uint64_t pack(std::uint64_t lo, std::uint64_t hi) { return (lo << 32) | hi; }
+
+    // The owner claims chunks from the front.
+    bool pop_front(size_t& chunk) {
+        std::uint64_t b = bounds.load(std::memory_order_acquire);
+        while ((b >> 32) < (b & 0xFFFFFFFF)) {
+            if (bounds.compare_exchange_weak(b, pack((b >> 32) + 1, b & 0xFFFFFFFF), std::memory_order_acq_rel)) {
+                chunk = static_cast<size_t>(b >> 32);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A thief takes the back half of the victim's remaining chunks.
+    bool steal_into(work_range& thief) {
+        std::uint64_t b = bounds.load(std::memory_order_acquire);
+        while ((b >> 32) < (b & 0xFFFFFFFF)) {
+            std::uint64_t lo = b >> 32;
+            std::uint64_t hi = b & 0xFFFFFFFF;
+            std::uint64_t mid = hi - (hi - lo + 1) / 2;
+            if (bounds.compare_exchange_weak(b, pack(lo, mid), std::memory_order_acq_rel)) {
+                thief.bounds.store(pack(mid, hi), std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::atomic<std::uint64_t> bounds{0};
+    char padding[SG14_CACHE_LINE_SIZE - sizeof(std::atomic<std::uint64_t>)];
+};
+
+// Calls run(c) once for each chunk index c in [0, num_chunks), on up to
+// num_threads threads including the calling one. Each thread starts with
+// an equal share of the chunks and, once it runs out, steals half of the
+// remaining share of another thread. Returns after every chunk has run.
+// If a thread cannot be created, the threads that did start, and the
+// calling one, steal the shares nobody picked up.
+template<class F>
+inline void parallel_chunks(size_t num_chunks, unsigned num_threads, const F& run)
+{
+    if (num_threads > num_chunks) {
+        num_threads = static_cast<unsigned>(num_chunks);
+    }
+    if (num_threads <= 1) {
+        for (size_t c = 0; c < num_chunks; ++c) {
+            run(c);
+        }
+        return;
+    }
+    std::unique_ptr<work_range[]> ranges(new work_range[num_threads]);
+    for (unsigned t = 0; t < num_threads; ++t) {
+        ranges[t].bounds.store(work_range::pack(num_chunks * t / num_threads, num_chunks * (t + 1) / num_threads), std::memory_order_relaxed);
+    }
+    auto worker = [&](unsigned self) {
+        size_t c;
+        while (true) {
+            if (ranges[self].pop_front(c)) {
+                run(c);
+                continue;
+            }
+            bool stole = false;
+            for (unsigned i = 1; i < num_threads && !stole; ++i) {
+                stole = ranges[(self + i) % num_threads].steal_into(ranges[self]);
+            }
+            if (!stole) {
+                return;  // every share is empty, and nobody hands out new work
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (unsigned t = 1; t < num_threads; ++t) {
+        try {
+            threads.emplace_back(worker, t);
+        } catch (const std::system_error&) {
+            break;  // carry on with fewer threads
+        }
+    }
+    worker(0);
+    for (auto&& t : threads) {
+        t.join();
+    }
+}
+
+} // namespace slot_map_detail
+
+namespace slot_map_detail {
+
+constexpr size_t floor_pow2(size_t n) { return (n < 2) ? 1 : 2 * floor_pow2(n / 2); }
+constexpr int log2_pow2(size_t n) { return (n < 2) ? 0 : 1 + log2_pow2(n / 2); }
+
 } // namespace slot_map_detail
 
+// chunked_vector is a sequence container for use as the Container parameter
+// of slot_map. Elements live in fixed-size chunks of chunk_size elements,
+// where chunk_size is a power of two, so that indexing is a shift and a mask.
+// Growing the container allocates a new chunk and never moves or copies
+// existing elements: pointers and references stay valid until the element is
+// erased. Iterators, as with std::deque, are invalidated by emplace_back.
+// Elements are contiguous within each chunk; see segment_begin().
+//
+template<class T, class Allocator = std::allocator<T>>
+class chunked_vector
+{
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using chunk_pointer = typename alloc_traits::pointer;
+    using map_type = std::vector<chunk_pointer, typename alloc_traits::template rebind_alloc<chunk_pointer>>;
+
+    template<bool IsConst>
+    class iterator_impl {
+        friend class chunked_vector;
+        friend class iterator_impl<!IsConst>;
+        using map_pointer = const chunk_pointer*;
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        iterator_impl() = default;
+        template<bool C = IsConst, class = std::enable_if_t<C>>
+        iterator_impl(const iterator_impl<false>& rhs) noexcept : map_(rhs.map_), index_(rhs.index_) {}
+
+        reference operator*() const { return map_[index_ >> chunk_shift][index_ & chunk_mask]; }
+        pointer operator->() const { return std::addressof(**this); }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        iterator_impl& operator++() { ++index_; return *this; }
+        iterator_impl& operator--() { --index_; return *this; }
+        iterator_impl operator++(int) { auto copy = *this; ++index_; return copy; }
+        iterator_impl operator--(int) { auto copy = *this; --index_; return copy; }
+        iterator_impl& operator+=(difference_type n) { index_ += n; return *this; }
+        iterator_impl& operator-=(difference_type n) { index_ -= n; return *this; }
+        friend iterator_impl operator+(iterator_impl it, difference_type n) { it += n; return it; }
+        friend iterator_impl operator+(difference_type n, iterator_impl it) { it += n; return it; }
+        friend iterator_impl operator-(iterator_impl it, difference_type n) { it -= n; return it; }
+        friend difference_type operator-(const iterator_impl& a, const iterator_impl& b) {
+            return static_cast<difference_type>(a.index_ - b.index_);
+        }
+
+        friend bool operator==(const iterator_impl& a, const iterator_impl& b) { return a.index_ == b.index_; }
+        friend bool operator!=(const iterator_impl& a, const iterator_impl& b) { return a.index_ != b.index_; }
+        friend bool operator<(const iterator_impl& a, const iterator_impl& b) { return a.index_ < b.index_; }
+        friend bool operator>(const iterator_impl& a, const iterator_impl& b) { return a.index_ > b.index_; }
+        friend bool operator<=(const iterator_impl& a, const iterator_impl& b) { return a.index_ <= b.index_; }
+        friend bool operator>=(const iterator_impl& a, const iterator_impl& b) { return a.index_ >= b.index_; }
+
+    private:
+        explicit iterator_impl(map_pointer map, size_t index) noexcept : map_(map), index_(index) {}
+
+        map_pointer map_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = iterator_impl<false>;
+    using const_iterator = iterator_impl<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Chunks hold at least 16 elements, and otherwise about 4KB.
+    static constexpr size_type chunk_size = slot_map_detail::floor_pow2(
+        (4096 / sizeof(T) > 16) ? 4096 / sizeof(T) : 16
+    );
+
+    chunked_vector() = default;
+    explicit chunked_vector(const Allocator& a) : alloc_(a), map_(typename map_type::allocator_type(a)) {}
+    // Delegating makes *this a complete object before any element is copied,
+    // so that if a copy throws the destructor frees what was built so far.
+    chunked_vector(const chunked_vector& rhs) :
+        chunked_vector(alloc_traits::select_on_container_copy_construction(rhs.alloc_))
+    {
+        this->append_copies(rhs);
+    }
+    chunked_vector(chunked_vector&& rhs) noexcept :
+        alloc_(std::move(rhs.alloc_)), map_(std::move(rhs.map_)), size_(rhs.size_)
+    {
+        rhs.map_.clear();
+        rhs.size_ = 0;
+    }
+    chunked_vector& operator=(const chunked_vector& rhs) {
+        if (this != &rhs) {
+            // Build the copy aside, with the allocator *this will end up
+            // using, so that a throwing copy leaves *this unchanged.
+            const bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+            chunked_vector copy(propagate ? rhs.alloc_ : alloc_);
+            copy.append_copies(rhs);
+            this->swap_storage(copy);
+            if (propagate) {
+                using std::swap;
+                swap(alloc_, copy.alloc_);
+            }
+        }
+        return *this;
+    }
+    chunked_vector& operator=(chunked_vector&& rhs) noexcept(alloc_traits::propagate_on_container_move_assignment::value) {
+        if (this == &rhs) {
+        } else if (alloc_traits::propagate_on_container_move_assignment::value || alloc_ == rhs.alloc_) {
+            this->release();
+            if (alloc_traits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(rhs.alloc_);
+            }
+            this->swap_storage(rhs);
+        } else {
+            // The chunks cannot change hands, so move the elements one by one.
+            this->clear();
+            this->reserve(rhs.size_);
+            for (T& t : rhs) {
+                this->emplace_back(std::move(t));
+            }
+            rhs.clear();
+        }
+        return *this;
+    }
+    ~chunked_vector() { this->release(); }
+
+    allocator_type get_allocator() const { return alloc_; }
+
+    iterator begin() noexcept                       { return iterator(map_.data(), 0); }
+    iterator end() noexcept                         { return iterator(map_.data(), size_); }
+    const_iterator begin() const noexcept           { return const_iterator(map_.data(), 0); }
+    const_iterator end() const noexcept             { return const_iterator(map_.data(), size_); }
+    const_iterator cbegin() const noexcept          { return begin(); }
+    const_iterator cend() const noexcept            { return end(); }
+    reverse_iterator rbegin() noexcept              { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept                { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept  { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept    { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept   { return rend(); }
+
+    reference operator[](size_type i)               { return map_[i >> chunk_shift][i & chunk_mask]; }
+    const_reference operator[](size_type i) const   { return map_[i >> chunk_shift][i & chunk_mask]; }
+    reference front()                               { return (*this)[0]; }
+    const_reference front() const                   { return (*this)[0]; }
+    reference back()                                { return (*this)[size_ - 1]; }
+    const_reference back() const                    { return (*this)[size_ - 1]; }
+
+    bool empty() const noexcept                     { return size_ == 0; }
+    size_type size() const noexcept                 { return size_; }
+    size_type capacity() const noexcept             { return map_.size() * chunk_size; }
+
+    // The segment functions expose the elements as contiguous runs, one per
+    // chunk in use, for loops that want to iterate over plain pointers.
+    //
+    size_type segment_count() const noexcept        { return (size_ + chunk_mask) >> chunk_shift; }
+    pointer segment_begin(size_type s) noexcept     { return std::addressof(*map_[s]); }
+    pointer segment_end(size_type s) noexcept       { return segment_begin(s) + segment_size(s); }
+    const_pointer segment_begin(size_type s) const noexcept { return std::addressof(*map_[s]); }
+    const_pointer segment_end(size_type s) const noexcept   { return segment_begin(s) + segment_size(s); }
+    size_type segment_size(size_type s) const noexcept {
+        return ((s + 1) << chunk_shift <= size_) ? chunk_size : size_ - (s << chunk_shift);
+    }
+
+    // reserve(n) allocates chunks up front; it never relocates elements.
+    //
+    void reserve(size_type n) {
+        map_.reserve((n + chunk_mask) >> chunk_shift);
+        while (this->capacity() < n) {
+            this->add_chunk();
+        }
+    }
+    // shrink_to_fit() frees the chunks that hold no elements.
+    void shrink_to_fit() {
+        while (map_.size() > this->segment_count()) {
+            alloc_traits::deallocate(alloc_, map_.back(), chunk_size);
+            map_.pop_back();
+        }
+    }
+
+    template<class... Args>
+    reference emplace_back(Args&&... args) {
+        if (size_ == this->capacity()) {
+            this->add_chunk();
+        }
+        T *p = std::addressof((*this)[size_]);
+        alloc_traits::construct(alloc_, p, std::forward<Args>(args)...);
+        ++size_;
+        return *p;
+    }
+    void push_back(const T& t) { this->emplace_back(t); }
+    void push_back(T&& t) { this->emplace_back(std::move(t)); }
+    void pop_back() {
+        --size_;
+        alloc_traits::destroy(alloc_, std::addressof((*this)[size_]));
+    }
+    void clear() noexcept {
+        while (size_ != 0) {
+            this->pop_back();
+        }
+    }
+
+    void swap(chunked_vector& rhs) noexcept {
+        if (alloc_traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, rhs.alloc_);
+        }
+        this->swap_storage(rhs);
+    }
+    friend void swap(chunked_vector& a, chunked_vector& b) noexcept { a.swap(b); }
+
+private:
+    static constexpr int chunk_shift = slot_map_detail::log2_pow2(chunk_size);
+    static constexpr size_type chunk_mask = chunk_size - 1;
+
+    // Grows map_ before allocating, so that the push_back cannot throw and
+    // leak the new chunk.
+    void add_chunk() {
+        if (map_.size() == map_.capacity()) {
+            map_.reserve(2 * map_.size() + 1);
+        }
+        map_.push_back(alloc_traits::allocate(alloc_, chunk_size));
+    }
+    void append_copies(const chunked_vector& rhs) {
+        this->reserve(size_ + rhs.size_);
+        for (const T& t : rhs) {
+            this->emplace_back(t);
+        }
+    }
+    void swap_storage(chunked_vector& rhs) noexcept {
+        using std::swap;
+        swap(map_, rhs.map_);
+        swap(size_, rhs.size_);
+    }
+    void release() noexcept {
+        this->clear();
+        for (chunk_pointer p : map_) {
+            alloc_traits::deallocate(alloc_, p, chunk_size);
+        }
+        map_.clear();
+    }
+
+    Allocator alloc_;
+    map_type map_;  // one pointer per chunk
+    size_type size_ = 0;
+};
+
+// Policies for the GenerationPolicy parameter of slot_map, which decides
+// what happens to a slot whose generation counter is about to wrap around.
+// Erased slots go to the back of the free list, so with plenty of free
+// slots each one's generation advances slowly; but a narrow generation
+// field, like 8 bits, still wraps quickly on a busy slot, after which old
+// keys for that slot compare valid again.
+namespace generation_policy {
+
+// wrap lets the generation counter wrap around and keeps reusing the slot.
+struct wrap {
+    static constexpr bool retire_slots = false;
+};
+
+// retire takes a slot out of service when its generation reaches the last
+// value before wrapping around. That generation is never handed out in a
+// key, so no key ever aliases a later value, and find() pays nothing for
+// the check; the cost is one slot per 2^bits erasures in it. Once no new
+// slot index fits in the key, emplace throws std::length_error.
+struct retire {
+    static constexpr bool retire_slots = true;
+};
+
+} // namespace generation_policy
+
 template<
     class T,
     class Key = std::pair<unsigned, unsigned>,
-    template<class...> class Container = std::vector
+    template<class...> class Container = std::vector,
+    class GenerationPolicy = generation_policy::wrap
 >
 class slot_map
 {
-#if __cplusplus >= 201703L
-    static constexpr auto get_index(const Key& k) { const auto& [idx, gen] = k; return idx; }
-    static constexpr auto get_generation(const Key& k) { const auto& [idx, gen] = k; return gen; }
-    template<class Integral> static constexpr void set_index(Key& k, Integral value) { auto& [idx, gen] = k; idx = static_cast<key_index_type>(value); }
-    static constexpr void increment_generation(Key& k) { auto& [idx, gen] = k; ++gen; }
-#else
-    static constexpr auto get_index(const Key& k) { using std::get; return get<0>(k); }
-    static constexpr auto get_generation(const Key& k) { using std::get; return get<1>(k); }
-    template<class Integral> static constexpr void set_index(Key& k, Integral value) { using std::get; get<0>(k) = static_cast<key_index_type>(value); }
-    static constexpr void increment_generation(Key& k) { using std::get; ++get<1>(k); }
-#endif
+    static constexpr auto get_index(const Key& k) { return slot_map_key_traits<Key>::get_index(k); }
+    static constexpr auto get_generation(const Key& k) { return slot_map_key_traits<Key>::get_generation(k); }
+    template<class Integral> static constexpr void set_index(Key& k, Integral value) { slot_map_key_traits<Key>::set_index(k, value); }
+    static constexpr void increment_generation(Key& k) { slot_map_key_traits<Key>::increment_generation(k); }
 
     using slot_iterator = typename Container<Key>::iterator;
 
@@ -164,6 +808,114 @@ public:
         return value_iter;
     }
 
+    // The find_batch() functions behave like calling find() on each key in
+    // [first, last) and writing the results to out, in order.
+    // When the key and value containers are random-access and too large to
+    // stay in cache, the keys are processed in blocks: all of a block's slots are prefetched, then its
+    // generations are checked and its values prefetched, then the results
+    // are written, so that the cache misses of a block overlap each other.
+    // O(1) time complexity per key and O(1) space complexity.
+    //
+    template<class InputIterator, class OutputIterator>
+    constexpr OutputIterator find_batch(InputIterator first, InputIterator last, OutputIterator out) {
+        return find_batch_impl(*this, first, last, out);
+    }
+    template<class InputIterator, class OutputIterator>
+    constexpr OutputIterator find_batch(InputIterator first, InputIterator last, OutputIterator out) const {
+        return find_batch_impl(*this, first, last, out);
+    }
+
+    // The parallel functions divide the values into chunks of about grain
+    // values, and process them on num_threads threads (by default, one per
+    // hardware thread) with a work-stealing scheduler, returning when all
+    // chunks are done.
+    // parallel_for_each_chunk calls f(first, last) for contiguous runs of
+    // values: first and last are raw pointers when the container is a
+    // vector or chunked_vector (runs never cross a chunk boundary), and
+    // container iterators otherwise. Containers without random access are
+    // processed as a single chunk on the calling thread.
+    // f runs concurrently with itself, must not throw, and must not insert
+    // into or erase from this slot_map, so the mapping from keys to values
+    // is unchanged for the whole pass.
+    // If the system cannot create as many threads as requested, the pass
+    // still covers every value, on the threads it could create plus the
+    // calling one.
+    // O(n) time complexity and O(num_threads) space complexity.
+    //
+    template<class F>
+    void parallel_for_each_chunk(F f, size_type grain = 0, unsigned num_threads = 0) {
+        this->parallel_for_each_run([&f](auto first, auto last, size_t) { f(first, last); }, grain, num_threads);
+    }
+    template<class F>
+    void parallel_for_each(F f, size_type grain = 0, unsigned num_threads = 0) {
+        this->parallel_for_each_run([&f](auto first, auto last, size_t) {
+            for (; first != last; ++first) {
+                f(*first);
+            }
+        }, grain, num_threads);
+    }
+    // parallel_transform writes f(value) to out[i] for the i-th value in
+    // iteration order; out must be a random-access iterator.
+    template<class RandomAccessIterator, class F>
+    void parallel_transform(RandomAccessIterator out, F f, size_type grain = 0, unsigned num_threads = 0) {
+        this->parallel_for_each_run([&f, out](auto first, auto last, size_t index) {
+            auto dest = out + index;
+            for (; first != last; ++first, ++dest) {
+                *dest = f(*first);
+            }
+        }, grain, num_threads);
+    }
+
+    // reorder(comp) permutes the values so that iteration visits them in
+    // the order given by comp, a strict weak ordering on values; the order
+    // of equivalent values is unspecified. sort_values() orders by operator<.
+    // Every key still refers to the same value afterwards.
+    // If moving a value throws, the map is left in an unspecified state.
+    // O(n log n) time and O(n) space complexity.
+    //
+    template<class Compare>
+    void reorder(Compare comp) {
+        const size_t n = values_.size();
+        auto value_at = slot_map_detail::index_container(values_);
+        auto reverse_map_at = slot_map_detail::index_container(reverse_map_);
+        auto slot_at = slot_map_detail::index_container(slots_);
+
+        // The value that belongs at position i is currently at order[i].
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), size_t());
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return comp(*value_at(a), *value_at(b));
+        });
+
+        std::vector<key_index_type> new_reverse_map(n);
+        for (size_t i = 0; i < n; ++i) {
+            new_reverse_map[i] = *reverse_map_at(order[i]);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            *reverse_map_at(i) = new_reverse_map[i];
+            this->set_index(*slot_at(new_reverse_map[i]), i);
+        }
+
+        // Apply the permutation one cycle at a time, marking each finished
+        // position as order[j] == j.
+        for (size_t i = 0; i < n; ++i) {
+            if (order[i] == i) {
+                continue;
+            }
+            mapped_type displaced = std::move(*value_at(i));
+            size_t j = i;
+            while (order[j] != i) {
+                size_t next = order[j];
+                *value_at(j) = std::move(*value_at(next));
+                order[j] = j;
+                j = next;
+            }
+            *value_at(j) = std::move(displaced);
+            order[j] = j;
+        }
+    }
+    void sort_values() { this->reorder(std::less<>()); }
+
     // The find_unchecked() functions perform no checks of any kind.
     // O(1) time and space complexity.
     //
@@ -219,9 +971,10 @@ public:
     // generation counter increases to be more evenly distributed across the slots.
     //
     constexpr void reserve_slots(size_type n) {
-        slot_map_detail::reserve_if_possible(slots_, n);
         key_index_type original_num_slots = static_cast<key_index_type>(slots_.size());
         if (original_num_slots < n) {
+            this->check_new_slot_index(n - 1);
+            slot_map_detail::reserve_if_possible(slots_, n);
             slots_.emplace_back(key_type{next_available_slot_index_, key_generation_type{}});
             key_index_type last_new_slot = original_num_slots;
             --n;
@@ -242,6 +995,9 @@ public:
     constexpr key_type insert(mapped_type&& value)        { return this->emplace(std::move(value)); }
 
     template<class... Args> constexpr key_type emplace(Args&&... args) {
+        if (next_available_slot_index_ == slots_.size()) {
+            this->check_new_slot_index(slots_.size());
+        }
         auto value_pos = values_.size();
         values_.emplace_back(std::forward<Args>(args)...);
         reverse_map_.emplace_back(next_available_slot_index_);
@@ -263,6 +1019,39 @@ public:
         return result;
     }
 
+    // insert_n(n, value, out) inserts n copies of value, and
+    // emplace_range(first, last, out) inserts one value constructed from
+    // each element of [first, last). Both write the new keys to out, in
+    // order, and return the end of the output.
+    // The values are appended first; then the slots for all of them are
+    // taken from the free list, and reverse_map_ grows, in one pass.
+    // Each container grows at most once when the number of new values is
+    // known up front, that is, always for insert_n and when InputIterator
+    // is a forward iterator for emplace_range.
+    // If constructing a value throws, the values appended so far by this
+    // call are removed again and the map is unchanged. If writing to out
+    // throws, the map stays consistent, and every value whose slot was
+    // already linked stays in it, including those whose keys were never
+    // written; the values after them are removed again.
+    // O(n) time complexity and O(1) space complexity.
+    //
+    template<class OutputIterator>
+    OutputIterator insert_n(size_type n, const mapped_type& value, OutputIterator out) {
+        bulk_append_guard guard(*this, n);
+        for (size_type i = 0; i < n; ++i) {
+            values_.emplace_back(value);
+        }
+        return guard.commit(out);
+    }
+    template<class InputIterator, class OutputIterator>
+    OutputIterator emplace_range(InputIterator first, InputIterator last, OutputIterator out) {
+        bulk_append_guard guard(*this, bulk_size_hint(first, last, typename std::iterator_traits<InputIterator>::iterator_category{}));
+        for (; first != last; ++first) {
+            values_.emplace_back(*first);
+        }
+        return guard.commit(out);
+    }
+
     // Each erase() version has an O(1) time complexity per value
     // and O(1) space complexity.
     //
@@ -292,6 +1081,55 @@ public:
         return 1;
     }
 
+    // erase_keys(first, last) erases the value of each key in [first, last)
+    // that is valid, and returns the number of values erased; expired and
+    // repeated keys are ignored.
+    // The values are erased from the back of the container forward, so
+    // that a value which is itself about to be erased is never moved into
+    // a hole: each erased value costs at most one move of another value.
+    // The order comes from a bitmap of value positions when the keys are
+    // numerous compared to size(), and from sorting the keys otherwise.
+    // O(k log k) or O(k + n/64) time complexity, for k keys, whichever is
+    // lower, and O(k) or O(n/64) space complexity to match.
+    //
+    template<class InputIterator>
+    size_type erase_keys(InputIterator first, InputIterator last) {
+        // Positions in values_ of the values whose keys are valid.
+        std::vector<size_type> doomed;
+        auto slots_begin = slots_.begin();
+        for (; first != last; ++first) {
+            auto slot_index = get_index(*first);
+            if (slot_index < slots_.size()) {
+                const key_type& slot = *std::next(slots_begin, slot_index);
+                if (get_generation(slot) == get_generation(*first)) {
+                    doomed.push_back(static_cast<size_type>(get_index(slot)));
+                }
+            }
+        }
+        const size_t n = values_.size();
+        if (doomed.size() * 16 < n / 64) {
+            std::sort(doomed.begin(), doomed.end(), std::greater<>());
+            doomed.erase(std::unique(doomed.begin(), doomed.end()), doomed.end());
+            for (size_type value_index : doomed) {
+                this->erase_value_index(value_index);
+            }
+            return static_cast<size_type>(doomed.size());
+        }
+        std::vector<std::uint64_t> marks((n + 63) / 64);
+        for (size_type value_index : doomed) {
+            marks[value_index / 64] |= std::uint64_t(1) << (value_index % 64);
+        }
+        size_type count = 0;
+        for (size_t w = marks.size(); w-- != 0; ) {
+            for (std::uint64_t bits = marks[w]; bits != 0; ++count) {
+                unsigned top = slot_map_detail::highest_bit(bits);
+                bits &= ~(std::uint64_t(1) << top);
+                this->erase_value_index(static_cast<size_type>(w * 64 + top));
+            }
+        }
+        return count;
+    }
+
     // clear() has O(n) time complexity and O(1) space complexity.
     // It also has semantics differing from erase(begin(), end())
     // in that it also resets the generation counter of every slot
@@ -306,6 +1144,58 @@ public:
         last_available_slot_index_ = key_index_type{};
     }
 
+    // The snapshot functions save and restore the complete state of a
+    // slot_map whose key and value types are trivially copyable, so that
+    // every key, generation counter and the free list survive exactly.
+    // write_snapshot(write) calls write(const void *p, size_t bytes) for
+    // consecutive pieces of a snapshot of snapshot_size() bytes in total,
+    // for example to fwrite them or copy them into a mapped file.
+    // load_snapshot(data, size) replaces the contents of *this with the
+    // snapshot at data, copying each array as a block; it throws
+    // std::invalid_argument, leaving *this unchanged, if the snapshot is
+    // not valid for this slot_map type or its slots, reverse map and free
+    // list are inconsistent. A snapshot can also be read in place, without
+    // copying, through slot_map_snapshot_view.
+    // O(n) time complexity and O(1) additional space complexity.
+    //
+    size_type snapshot_size() const {
+        return static_cast<size_type>(this->snapshot_header().total_size);
+    }
+    template<class Writer>
+    void write_snapshot(Writer write) const {
+        static_assert(slot_map_detail::is_snapshottable<key_type>::value && slot_map_detail::is_snapshottable<mapped_type>::value,
+                      "snapshots require trivially copyable key and value types");
+        static const char zeros[slot_map_detail::snapshot_alignment] = {};
+        const slot_map_detail::snapshot_header h = this->snapshot_header();
+        std::uint64_t offset = 0;
+        auto write_section = [&](std::uint64_t section_offset, const auto& ctr) {
+            write(static_cast<const void*>(zeros), static_cast<size_t>(section_offset - offset));
+            auto writer = [&write](auto first, auto last, size_t) { slot_map_detail::write_run(write, first, last, 0); };
+            slot_map_detail::for_each_run(ctr, 0, ctr.size(), writer, slot_map_detail::priority_tag<2>{});
+            offset = section_offset + ctr.size() * sizeof(*ctr.begin());
+        };
+        write(static_cast<const void*>(&h), sizeof h);
+        offset = sizeof h;
+        write_section(h.slots_offset, slots_);
+        write_section(h.reverse_map_offset, reverse_map_);
+        write_section(h.values_offset, values_);
+    }
+    void load_snapshot(const void *data, size_t size) {
+        static_assert(slot_map_detail::is_snapshottable<key_type>::value && slot_map_detail::is_snapshottable<mapped_type>::value,
+                      "snapshots require trivially copyable key and value types");
+        const slot_map_detail::snapshot_header h =
+            slot_map_detail::read_snapshot_header<key_type, key_index_type, mapped_type>(data, size);
+        const char *base = static_cast<const char*>(data);
+        slot_map_detail::validate_snapshot_arrays<key_type, key_index_type>(h, base);
+        slot_map loaded;
+        load_section(loaded.slots_, base + h.slots_offset, static_cast<size_t>(h.slot_count));
+        load_section(loaded.reverse_map_, base + h.reverse_map_offset, static_cast<size_t>(h.size));
+        load_section(loaded.values_, base + h.values_offset, static_cast<size_t>(h.size));
+        loaded.next_available_slot_index_ = static_cast<key_index_type>(h.next_available_slot_index);
+        loaded.last_available_slot_index_ = static_cast<key_index_type>(h.last_available_slot_index);
+        this->swap(loaded);
+    }
+
     // swap is not mentioned in P0661r1 but it should be.
     constexpr void swap(slot_map& rhs) {
         using std::swap;
@@ -324,6 +1214,196 @@ protected:
     constexpr Container<mapped_type>&& c() && noexcept { return std::move(values_); }
     constexpr const Container<mapped_type>&& c() const&& noexcept { return std::move(values_); }
 
+private:
+    template<class Self, class InputIterator, class OutputIterator>
+    static constexpr OutputIterator find_batch_impl(Self& self, InputIterator first, InputIterator last, OutputIterator out) {
+        using value_iter_t = decltype(self.values_.begin());
+        constexpr bool is_random_access =
+            slot_map_detail::is_random_access_iterator<value_iter_t>::value &&
+            slot_map_detail::is_random_access_iterator<decltype(self.slots_.begin())>::value;
+        // When the slots fit comfortably in cache, prefetching only adds overhead.
+        constexpr size_type min_slots_to_prefetch = 32768;
+        if (!is_random_access || self.slots_.size() < min_slots_to_prefetch) {
+            for (; first != last; ++first) {
+                *out = self.find(*first);
+                ++out;
+            }
+            return out;
+        }
+
+        constexpr int block_size = 16;
+        const size_type num_slots = self.slots_.size();
+        const auto slots_begin = self.slots_.begin();
+        const value_iter_t values_begin = self.values_.begin();
+        const value_iter_t values_end = self.values_.end();
+        size_type value_index[block_size] = {};
+        key_generation_type generation[block_size] = {};
+        while (first != last) {
+            // Pass 1: read the keys and prefetch their slots.
+            int n = 0;
+            for (; n < block_size && first != last; ++n, ++first) {
+                auto slot_index = static_cast<size_type>(get_index(*first));
+                generation[n] = get_generation(*first);
+                value_index[n] = slot_index;
+                if (slot_index < num_slots) {
+                    slot_map_detail::prefetch_element(std::next(slots_begin, slot_index));
+                }
+            }
+            // Pass 2: check generations and prefetch the surviving values.
+            for (int i = 0; i < n; ++i) {
+                size_type result = self.values_.size();
+                if (value_index[i] < num_slots) {
+                    const key_type& slot = *std::next(slots_begin, value_index[i]);
+                    if (get_generation(slot) == generation[i]) {
+                        result = static_cast<size_type>(get_index(slot));
+                        slot_map_detail::prefetch_element(std::next(values_begin, result));
+                    }
+                }
+                value_index[i] = result;
+            }
+            // Pass 3: emit the results.
+            for (int i = 0; i < n; ++i) {
+                *out = (value_index[i] == self.values_.size()) ? values_end : std::next(values_begin, value_index[i]);
+                ++out;
+            }
+        }
+        return out;
+    }
+
+    template<class InputIterator>
+    static size_type bulk_size_hint(InputIterator, InputIterator, std::input_iterator_tag) { return 0; }
+    template<class ForwardIterator>
+    static size_type bulk_size_hint(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag) {
+        return static_cast<size_type>(std::distance(first, last));
+    }
+
+    // Reserves room for n more values, lets the caller append values to
+    // values_, and then links every appended value to a slot. Appended
+    // values that were never linked are popped again on destruction.
+    class bulk_append_guard {
+    public:
+        explicit bulk_append_guard(slot_map& sm, size_type n) : sm_(sm), old_size_(sm.values_.size()) {
+            if (n != 0) {
+                slot_map_detail::reserve_if_possible(sm_.values_, old_size_ + n);
+                slot_map_detail::reserve_if_possible(sm_.reverse_map_, old_size_ + n);
+                if (sm_.slots_.size() < old_size_ + n) {
+                    slot_map_detail::reserve_if_possible(sm_.slots_, old_size_ + n);
+                }
+            }
+        }
+        bulk_append_guard(const bulk_append_guard&) = delete;
+        bulk_append_guard& operator=(const bulk_append_guard&) = delete;
+        ~bulk_append_guard() {
+            while (sm_.values_.size() > sm_.reverse_map_.size()) {
+                sm_.values_.pop_back();
+            }
+        }
+
+        template<class OutputIterator>
+        OutputIterator commit(OutputIterator out) {
+            const size_type new_size = sm_.values_.size();
+            if (new_size == old_size_) {
+                return out;
+            }
+            slot_map_detail::reserve_if_possible(sm_.reverse_map_, new_size);
+            // First pop the free list...
+            size_type value_pos = old_size_;
+            auto slots_begin = sm_.slots_.begin();
+            for (; value_pos != new_size && sm_.next_available_slot_index_ != sm_.slots_.size(); ++value_pos) {
+                key_index_type slot_index = sm_.next_available_slot_index_;
+                auto slot_iter = std::next(slots_begin, slot_index);
+                if (slot_index == sm_.last_available_slot_index_) {
+                    sm_.next_available_slot_index_ = static_cast<key_index_type>(sm_.slots_.size());
+                    sm_.last_available_slot_index_ = sm_.next_available_slot_index_;
+                } else {
+                    sm_.next_available_slot_index_ = get_index(*slot_iter);
+                }
+                set_index(*slot_iter, value_pos);
+                sm_.reverse_map_.emplace_back(slot_index);
+                key_type result = *slot_iter;
+                set_index(result, slot_index);
+                *out = result;
+                ++out;
+            }
+            // ...then append slots for the rest, which need no linking. The
+            // map is made consistent before any of their keys are written,
+            // so that a throwing output iterator cannot corrupt it.
+            if (value_pos != new_size) {
+                sm_.check_new_slot_index(sm_.slots_.size() + (new_size - value_pos) - 1);
+                const auto first_new_slot = static_cast<key_index_type>(sm_.slots_.size());
+                for (size_type v = value_pos; v != new_size; ++v) {
+                    auto slot_index = static_cast<key_index_type>(sm_.slots_.size());
+                    sm_.slots_.emplace_back(key_type{static_cast<key_index_type>(v), key_generation_type{}});
+                    sm_.reverse_map_.emplace_back(slot_index);
+                    sm_.next_available_slot_index_ = static_cast<key_index_type>(sm_.slots_.size());
+                    sm_.last_available_slot_index_ = sm_.next_available_slot_index_;
+                }
+                auto slot_index = first_new_slot;
+                for (; value_pos != new_size; ++value_pos, ++slot_index) {
+                    *out = key_type{slot_index, key_generation_type{}};
+                    ++out;
+                }
+            }
+            return out;
+        }
+
+    private:
+        slot_map& sm_;
+        size_type old_size_;
+    };
+
+    template<class G>
+    void parallel_for_each_run(const G& g, size_type grain, unsigned num_threads) {
+        if (values_.size() != 0) {
+            this->parallel_for_each_run(g, grain, num_threads, slot_map_detail::is_random_access_iterator<iterator>{});
+        }
+    }
+    template<class G>
+    void parallel_for_each_run(const G& g, size_type, unsigned, std::false_type) {
+        slot_map_detail::for_each_run(values_, 0, values_.size(), g, slot_map_detail::priority_tag<0>{});
+    }
+    template<class G>
+    void parallel_for_each_run(const G& g, size_type grain, unsigned num_threads, std::true_type) {
+        const size_t n = values_.size();
+        size_t chunk_values = (grain != 0) ? grain : 4096;
+        if (n / chunk_values >= 0xFFFFFFFF) {
+            chunk_values = n / 0xFFFFFFFF + 1;  // the scheduler counts chunks in 32 bits
+        }
+        if (num_threads == 0) {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        slot_map_detail::parallel_chunks((n + chunk_values - 1) / chunk_values, num_threads, [&](size_t c) {
+            size_t a = c * chunk_values;
+            size_t b = (a + chunk_values < n) ? a + chunk_values : n;
+            slot_map_detail::for_each_run(values_, a, b, g, slot_map_detail::priority_tag<2>{});
+        });
+    }
+
+    slot_map_detail::snapshot_header snapshot_header() const {
+        return slot_map_detail::make_snapshot_header<key_type, key_index_type, mapped_type>(
+            values_.size(), slots_.size(), next_available_slot_index_, last_available_slot_index_);
+    }
+    template<class Ctr>
+    static void load_section(Ctr& ctr, const char *p, size_t n) {
+        using U = typename Ctr::value_type;
+        if (reinterpret_cast<std::uintptr_t>(p) % alignof(U) == 0) {
+            slot_map_detail::assign_from(ctr, reinterpret_cast<const U*>(p), n, slot_map_detail::priority_tag<1>{});
+        } else {
+            ctr.clear();
+            slot_map_detail::reserve_if_possible(ctr, n);
+            for (size_t i = 0; i < n; ++i) {
+                std::aligned_storage_t<sizeof(U), alignof(U)> u;
+                std::memcpy(&u, p + i * sizeof(U), sizeof(U));
+                ctr.emplace_back(*reinterpret_cast<const U*>(&u));
+            }
+        }
+    }
+
+    void erase_value_index(size_type value_index) {
+        auto slot_index = *std::next(reverse_map_.begin(), value_index);
+        this->erase_slot_iter(std::next(slots_.begin(), slot_index));
+    }
+
 private:
     constexpr slot_iterator slot_iter_from_value_iter(const_iterator value_iter) {
         auto value_index = std::distance(const_iterator(values_.begin()), value_iter);
@@ -345,6 +1425,10 @@ private:
         values_.pop_back();
         reverse_map_.pop_back();
         // Expire this key.
+        this->increment_generation(*slot_iter);
+        if (GenerationPolicy::retire_slots && is_last_generation(*slot_iter)) {
+            return std::next(values_.begin(), value_index);  // retire the slot: it never rejoins the free list
+        }
         if (next_available_slot_index_ == slots_.size()) {
             next_available_slot_index_ = static_cast<key_index_type>(slot_index);
             last_available_slot_index_ = static_cast<key_index_type>(slot_index);
@@ -353,10 +1437,20 @@ private:
             this->set_index(*last_slot_iter, slot_index);
             last_available_slot_index_ = static_cast<key_index_type>(slot_index);
         }
-        this->increment_generation(*slot_iter);
         return std::next(values_.begin(), value_index);
     }
 
+    // Whether incrementing k's generation once more would wrap it around.
+    static constexpr bool is_last_generation(const key_type& k) {
+        key_type probe = k;
+        increment_generation(probe);
+        return get_generation(probe) == key_generation_type{};
+    }
+
+    static constexpr void check_new_slot_index(size_t i) {
+        slot_map_key_detail::check_new_slot_index<key_type>(i);
+    }
+
     Container<key_type> slots_;  // high_water_mark() entries
     Container<key_index_type> reverse_map_;  // exactly size() entries
     Container<mapped_type> values_;  // exactly size() entries
@@ -371,9 +1465,86 @@ private:
     // is only one available slot at the moment).
 };
 
-template<class T, class Key, template<class...> class Container>
-constexpr void swap(slot_map<T, Key, Container>& lhs, slot_map<T, Key, Container>& rhs) {
+template<class T, class Key, template<class...> class Container, class GenerationPolicy>
+constexpr void swap(slot_map<T, Key, Container, GenerationPolicy>& lhs, slot_map<T, Key, Container, GenerationPolicy>& rhs) {
     lhs.swap(rhs);
 }
 
+// A slot_map whose values, slots and reverse map all live in chunked_vectors:
+// insert never relocates existing values, so the latency of a growing map
+// does not spike when its storage fills up. Inserting never invalidates
+// references to values; erasing still moves the last value into the hole.
+template<class T, class Key = std::pair<unsigned, unsigned>, class GenerationPolicy = generation_policy::wrap>
+using stable_slot_map = slot_map<T, Key, chunked_vector, GenerationPolicy>;
+
+// slot_map_snapshot_view reads a snapshot written by slot_map::write_snapshot
+// in place, for example straight out of a memory-mapped file. Constructing
+// it validates the header and computes three pointers; no element is read
+// or copied. Lookups have the same semantics as the slot_map's.
+// The data must outlive the view, and be aligned to 64 bytes (as mapped
+// files are) or at least to alignof(Key) and alignof(T).
+// Unlike load_snapshot, the view trusts the contents of the arrays: find()
+// never reads outside them, but a damaged snapshot may map a key to the
+// wrong value.
+//
+template<class T, class Key = std::pair<unsigned, unsigned>>
+class slot_map_snapshot_view
+{
+    static constexpr auto get_index(const Key& k) { return slot_map_key_traits<Key>::get_index(k); }
+    static constexpr auto get_generation(const Key& k) { return slot_map_key_traits<Key>::get_generation(k); }
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using key_index_type = decltype(slot_map_snapshot_view::get_index(std::declval<Key>()));
+    using size_type = size_t;
+    using const_iterator = const T*;
+
+    explicit slot_map_snapshot_view(const void *data, size_t size) {
+        const slot_map_detail::snapshot_header h =
+            slot_map_detail::read_snapshot_header<Key, key_index_type, T>(data, size);
+        const char *base = static_cast<const char*>(data);
+        if (reinterpret_cast<std::uintptr_t>(base) % alignof(Key) != 0 ||
+            reinterpret_cast<std::uintptr_t>(base) % alignof(T) != 0) {
+            SLOT_MAP_THROW_EXCEPTION(std::invalid_argument, "snapshot is misaligned");
+        }
+        slots_ = reinterpret_cast<const Key*>(base + h.slots_offset);
+        values_ = reinterpret_cast<const T*>(base + h.values_offset);
+        size_ = static_cast<size_type>(h.size);
+        slot_count_ = static_cast<size_type>(h.slot_count);
+    }
+
+    const T& at(const key_type& key) const {
+        auto it = this->find(key);
+        if (it == this->end()) {
+            SLOT_MAP_THROW_EXCEPTION(std::out_of_range, "at");
+        }
+        return *it;
+    }
+    const T& operator[](const key_type& key) const { return values_[get_index(slots_[get_index(key)])]; }
+    const_iterator find(const key_type& key) const {
+        auto slot_index = get_index(key);
+        if (slot_index >= slot_count_ || get_generation(slots_[slot_index]) != get_generation(key)) {
+            return end();
+        }
+        auto value_index = get_index(slots_[slot_index]);
+        if (value_index >= size_) {
+            return end();
+        }
+        return values_ + value_index;
+    }
+
+    const_iterator begin() const { return values_; }
+    const_iterator end() const { return values_ + size_; }
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type slot_count() const { return slot_count_; }
+
+private:
+    const Key *slots_;
+    const T *values_;
+    size_type size_;
+    size_type slot_count_;
+};
+
 } // namespace stdext
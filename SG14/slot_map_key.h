@@ -0,0 +1,136 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#ifndef SLOT_MAP_THROW_EXCEPTION
+#include <stdexcept>
+#define SLOT_MAP_THROW_EXCEPTION(type, ...) throw type(__VA_ARGS__)
+#endif
+
+namespace stdext {
+
+// slot_map_key_traits<Key> is how slot_map and its siblings read and modify
+// the two fields of a key: the slot index and the generation counter.
+// The primary template handles any two-element aggregate or tuple-like
+// type, such as std::pair; specialize it for keys with a different shape.
+// Key must also be constructible as Key{index, generation}.
+//
+template<class Key>
+struct slot_map_key_traits {
+#if __cplusplus >= 201703L
+    static constexpr auto get_index(const Key& k) { const auto& [idx, gen] = k; return idx; }
+    static constexpr auto get_generation(const Key& k) { const auto& [idx, gen] = k; return gen; }
+    template<class Integral> static constexpr void set_index(Key& k, Integral value) { auto& [idx, gen] = k; idx = static_cast<decltype(get_index(k))>(value); }
+    static constexpr void increment_generation(Key& k) { auto& [idx, gen] = k; ++gen; }
+#else
+    static constexpr auto get_index(const Key& k) { using std::get; return get<0>(k); }
+    static constexpr auto get_generation(const Key& k) { using std::get; return get<1>(k); }
+    template<class Integral> static constexpr void set_index(Key& k, Integral value) { using std::get; get<0>(k) = static_cast<decltype(get_index(k))>(value); }
+    static constexpr void increment_generation(Key& k) { using std::get; ++get<1>(k); }
+#endif
+};
+
+// packed_key<UInt, IndexBits> is a key held in a single unsigned integer:
+// the low IndexBits bits are the slot index and the remaining high bits
+// the generation counter, which wraps around modulo 2^generation_bits.
+// Keys compare and hash as one word.
+//
+template<class UInt, unsigned IndexBits>
+class packed_key {
+    static_assert(std::is_unsigned<UInt>::value, "packed_key requires an unsigned integer type");
+    static_assert(0 < IndexBits && IndexBits < std::numeric_limits<UInt>::digits,
+                  "packed_key needs at least one bit each for the index and the generation");
+public:
+    using value_type = UInt;
+    static constexpr unsigned index_bits = IndexBits;
+    static constexpr unsigned generation_bits = std::numeric_limits<UInt>::digits - IndexBits;
+    static constexpr UInt index_mask = static_cast<UInt>((UInt(1) << IndexBits) - 1);
+    static constexpr UInt generation_one = static_cast<UInt>(UInt(1) << IndexBits);
+
+    constexpr packed_key() noexcept = default;
+    constexpr packed_key(UInt index, UInt generation) noexcept :
+        value_(static_cast<UInt>((generation << IndexBits) | (index & index_mask))) {}
+
+    static constexpr packed_key from_value(UInt value) noexcept { packed_key k; k.value_ = value; return k; }
+    constexpr UInt value() const noexcept { return value_; }
+    constexpr UInt index() const noexcept { return static_cast<UInt>(value_ & index_mask); }
+    constexpr UInt generation() const noexcept { return static_cast<UInt>(value_ >> IndexBits); }
+
+    constexpr void set_index(UInt index) noexcept { value_ = static_cast<UInt>((value_ & ~index_mask) | (index & index_mask)); }
+    constexpr void increment_generation() noexcept { value_ = static_cast<UInt>(value_ + generation_one); }
+
+    friend constexpr bool operator==(packed_key a, packed_key b) noexcept { return a.value_ == b.value_; }
+    friend constexpr bool operator!=(packed_key a, packed_key b) noexcept { return a.value_ != b.value_; }
+    friend constexpr bool operator<(packed_key a, packed_key b) noexcept { return a.value_ < b.value_; }
+    friend constexpr bool operator>(packed_key a, packed_key b) noexcept { return a.value_ > b.value_; }
+    friend constexpr bool operator<=(packed_key a, packed_key b) noexcept { return a.value_ <= b.value_; }
+    friend constexpr bool operator>=(packed_key a, packed_key b) noexcept { return a.value_ >= b.value_; }
+
+private:
+    UInt value_ = 0;
+};
+
+template<class UInt, unsigned IndexBits>
+struct slot_map_key_traits<packed_key<UInt, IndexBits>> {
+    using Key = packed_key<UInt, IndexBits>;
+    static constexpr UInt get_index(const Key& k) { return k.index(); }
+    static constexpr UInt get_generation(const Key& k) { return k.generation(); }
+    template<class Integral> static constexpr void set_index(Key& k, Integral value) { k.set_index(static_cast<UInt>(value)); }
+    static constexpr void increment_generation(Key& k) { k.increment_generation(); }
+};
+
+namespace slot_map_key_detail {
+
+// Throws std::length_error unless slot index i, and the free list's end
+// marker i + 1, both fit in a Key.
+template<class Key>
+constexpr void check_new_slot_index(std::size_t i) {
+    Key probe{};
+    slot_map_key_traits<Key>::set_index(probe, i + 1);
+    if (static_cast<std::size_t>(slot_map_key_traits<Key>::get_index(probe)) != i + 1) {
+        SLOT_MAP_THROW_EXCEPTION(std::length_error, "slot_map");
+    }
+}
+
+} // namespace slot_map_key_detail
+
+} // namespace stdext
+
+namespace std {
+
+template<class UInt, unsigned IndexBits>
+struct hash<stdext::packed_key<UInt, IndexBits>> {
+    size_t operator()(const stdext::packed_key<UInt, IndexBits>& k) const noexcept { return hash<UInt>()(k.value()); }
+};
+
+} // namespace std
@@ -0,0 +1,483 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// A slot_map whose values are split into parallel columns, one per element
+// type, for data that is usually processed a few fields at a time.
+//
+// All columns share a single key space: one slots_ array and one
+// reverse_map_ index. Value number i of every column belongs to the same
+// key, and erase() moves the last value of every column into the hole, just
+// as slot_map does with its single values_ container.
+
+#include "slot_map_key.h"
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef SLOT_MAP_THROW_EXCEPTION
+#include <stdexcept>
+#define SLOT_MAP_THROW_EXCEPTION(type, ...) throw type(__VA_ARGS__)
+#endif
+
+namespace stdext {
+
+namespace soa_slot_map_detail {
+
+template<bool...> struct bool_pack;
+template<bool... Bs>
+using all_true = std::is_same<bool_pack<true, Bs...>, bool_pack<Bs..., true>>;
+
+// Calls f(i) for each i in Is..., in order.
+template<class F, std::size_t... Is>
+inline void for_each_index(F&& f, std::index_sequence<Is...>)
+{
+    (void)std::initializer_list<int>{ (f(std::integral_constant<std::size_t, Is>{}), 0)... };
+}
+
+// A contiguous run of one column's values.
+template<class T>
+class column_span {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+    using iterator = T*;
+
+    constexpr column_span() noexcept = default;
+    constexpr column_span(T *data, size_type size) noexcept : data_(data), size_(size) {}
+    template<class U, class = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    constexpr column_span(const column_span<U>& rhs) noexcept : data_(rhs.data()), size_(rhs.size()) {}
+
+    constexpr T *data() const noexcept { return data_; }
+    constexpr size_type size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr T *begin() const noexcept { return data_; }
+    constexpr T *end() const noexcept { return data_ + size_; }
+    constexpr T& operator[](size_type i) const { return data_[i]; }
+
+private:
+    T *data_ = nullptr;
+    size_type size_ = 0;
+};
+
+// Iterates several columns in lockstep. Dereferencing yields a tuple of
+// references, which C++17 code can unpack with a structured binding.
+template<class... Us>
+class zip_iterator {
+    template<class...> friend class zip_iterator;
+    using indices = std::index_sequence_for<Us...>;
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::tuple<std::remove_cv_t<Us>...>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::tuple<Us&...>;
+    using pointer = void;
+
+    constexpr zip_iterator() = default;
+    constexpr explicit zip_iterator(std::tuple<Us*...> columns, std::size_t index) : columns_(columns), index_(index) {}
+    template<class... Vs, class = std::enable_if_t<!std::is_same<std::tuple<Vs...>, std::tuple<Us...>>::value &&
+                                                   std::is_convertible<std::tuple<Vs*...>, std::tuple<Us*...>>::value>>
+    constexpr zip_iterator(const zip_iterator<Vs...>& rhs) : columns_(rhs.columns_), index_(rhs.index_) {}
+
+    constexpr reference operator*() const { return deref(indices{}); }
+    constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+    // The position of this iterator's values within their columns.
+    constexpr std::size_t index() const noexcept { return index_; }
+
+    constexpr zip_iterator& operator++() { ++index_; return *this; }
+    constexpr zip_iterator& operator--() { --index_; return *this; }
+    constexpr zip_iterator operator++(int) { auto copy = *this; ++index_; return copy; }
+    constexpr zip_iterator operator--(int) { auto copy = *this; --index_; return copy; }
+    constexpr zip_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+    constexpr zip_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+    friend constexpr zip_iterator operator+(zip_iterator it, difference_type n) { it += n; return it; }
+    friend constexpr zip_iterator operator+(difference_type n, zip_iterator it) { it += n; return it; }
+    friend constexpr zip_iterator operator-(zip_iterator it, difference_type n) { it -= n; return it; }
+    friend constexpr difference_type operator-(const zip_iterator& a, const zip_iterator& b) {
+        return static_cast<difference_type>(a.index_ - b.index_);
+    }
+
+    friend constexpr bool operator==(const zip_iterator& a, const zip_iterator& b) { return a.index_ == b.index_; }
+    friend constexpr bool operator!=(const zip_iterator& a, const zip_iterator& b) { return a.index_ != b.index_; }
+    friend constexpr bool operator<(const zip_iterator& a, const zip_iterator& b) { return a.index_ < b.index_; }
+    friend constexpr bool operator>(const zip_iterator& a, const zip_iterator& b) { return a.index_ > b.index_; }
+    friend constexpr bool operator<=(const zip_iterator& a, const zip_iterator& b) { return a.index_ <= b.index_; }
+    friend constexpr bool operator>=(const zip_iterator& a, const zip_iterator& b) { return a.index_ >= b.index_; }
+
+private:
+    template<std::size_t... Is>
+    constexpr reference deref(std::index_sequence<Is...>) const { return reference(std::get<Is>(columns_)[index_]...); }
+
+    std::tuple<Us*...> columns_{};
+    std::size_t index_ = 0;
+};
+
+template<class... Us>
+class zip_view {
+public:
+    using iterator = zip_iterator<Us...>;
+    using size_type = std::size_t;
+
+    constexpr explicit zip_view(std::tuple<Us*...> columns, size_type size) : columns_(columns), size_(size) {}
+
+    constexpr iterator begin() const { return iterator(columns_, 0); }
+    constexpr iterator end() const { return iterator(columns_, size_); }
+    constexpr size_type size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+
+private:
+    std::tuple<Us*...> columns_;
+    size_type size_;
+};
+
+} // namespace soa_slot_map_detail
+
+template<class Key, class... Ts>
+class basic_soa_slot_map
+{
+    static_assert(sizeof...(Ts) != 0, "basic_soa_slot_map needs at least one column");
+    static_assert(soa_slot_map_detail::all_true<!std::is_same<Ts, bool>::value...>::value,
+                  "std::vector<bool> is not contiguous, so bool cannot be a column type");
+
+    static constexpr auto get_index(const Key& k) { return slot_map_key_traits<Key>::get_index(k); }
+    static constexpr auto get_generation(const Key& k) { return slot_map_key_traits<Key>::get_generation(k); }
+    template<class Integral> static constexpr void set_index(Key& k, Integral value) { slot_map_key_traits<Key>::set_index(k, value); }
+    static constexpr void increment_generation(Key& k) { slot_map_key_traits<Key>::increment_generation(k); }
+
+    using indices = std::index_sequence_for<Ts...>;
+
+public:
+    using key_type = Key;
+    using key_index_type = decltype(basic_soa_slot_map::get_index(std::declval<Key>()));
+    using key_generation_type = decltype(basic_soa_slot_map::get_generation(std::declval<Key>()));
+
+    template<std::size_t I> using column_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+    template<std::size_t I> using column_span = soa_slot_map_detail::column_span<column_type<I>>;
+    template<std::size_t I> using const_column_span = soa_slot_map_detail::column_span<const column_type<I>>;
+    template<class... Us> using zip_view = soa_slot_map_detail::zip_view<Us...>;
+
+    using value_type = std::tuple<Ts...>;
+    using reference = std::tuple<Ts&...>;
+    using const_reference = std::tuple<const Ts&...>;
+    using iterator = soa_slot_map_detail::zip_iterator<Ts...>;
+    using const_iterator = soa_slot_map_detail::zip_iterator<const Ts...>;
+    using size_type = std::size_t;
+
+    static constexpr size_type column_count = sizeof...(Ts);
+
+    // The at() functions have both generation counter checking
+    // and bounds checking, and throw if either check fails.
+    // O(1) time and space complexity.
+    //
+    reference at(const key_type& key) {
+        auto it = this->find(key);
+        if (it == this->end()) {
+            SLOT_MAP_THROW_EXCEPTION(std::out_of_range, "at");
+        }
+        return *it;
+    }
+    const_reference at(const key_type& key) const {
+        auto it = this->find(key);
+        if (it == this->end()) {
+            SLOT_MAP_THROW_EXCEPTION(std::out_of_range, "at");
+        }
+        return *it;
+    }
+    template<std::size_t I> column_type<I>& at(const key_type& key) {
+        return std::get<I>(columns_)[value_index_or_throw(key)];
+    }
+    template<std::size_t I> const column_type<I>& at(const key_type& key) const {
+        return std::get<I>(columns_)[value_index_or_throw(key)];
+    }
+
+    // The bracket operator[] has a generation counter check.
+    // If the check fails it is undefined behavior.
+    // O(1) time and space complexity.
+    //
+    reference operator[](const key_type& key)              { return *find_unchecked(key); }
+    const_reference operator[](const key_type& key) const  { return *find_unchecked(key); }
+
+    // The find() functions have generation counter checking.
+    // If the check fails, the result of end() is returned.
+    // O(1) time and space complexity.
+    //
+    iterator find(const key_type& key)                     { return begin() + value_index(key); }
+    const_iterator find(const key_type& key) const         { return begin() + value_index(key); }
+
+    // The find_unchecked() functions perform no checks of any kind.
+    // O(1) time and space complexity.
+    //
+    iterator find_unchecked(const key_type& key)             { return begin() + get_index(slots_[get_index(key)]); }
+    const_iterator find_unchecked(const key_type& key) const { return begin() + get_index(slots_[get_index(key)]); }
+
+    // Iterating the map visits every column in lockstep; zip<I, J...>()
+    // visits only the named columns, and column<I>() exposes one column
+    // as a contiguous span. All of these are invalidated by insertion,
+    // like std::vector iterators.
+    //
+    iterator begin()                         { return iterator(column_pointers(indices{}), 0); }
+    iterator end()                           { return iterator(column_pointers(indices{}), size()); }
+    const_iterator begin() const             { return const_iterator(column_pointers(indices{}), 0); }
+    const_iterator end() const               { return const_iterator(column_pointers(indices{}), size()); }
+    const_iterator cbegin() const            { return begin(); }
+    const_iterator cend() const              { return end(); }
+
+    template<std::size_t... Is>
+    zip_view<column_type<Is>...> zip() {
+        return zip_view<column_type<Is>...>(std::make_tuple(std::get<Is>(columns_).data()...), size());
+    }
+    template<std::size_t... Is>
+    zip_view<const column_type<Is>...> zip() const {
+        return zip_view<const column_type<Is>...>(std::make_tuple(std::get<Is>(columns_).data()...), size());
+    }
+
+    template<std::size_t I> column_span<I> column() {
+        return column_span<I>(std::get<I>(columns_).data(), size());
+    }
+    template<std::size_t I> const_column_span<I> column() const {
+        return const_column_span<I>(std::get<I>(columns_).data(), size());
+    }
+
+    bool empty() const                      { return reverse_map_.empty(); }
+    size_type size() const                  { return reverse_map_.size(); }
+    size_type capacity() const              { return reverse_map_.capacity(); }
+
+    // reserve(n) reserves n values in every column, and n slots.
+    //
+    void reserve(size_type n) {
+        soa_slot_map_detail::for_each_index([&](auto i) { std::get<decltype(i)::value>(columns_).reserve(n); }, indices{});
+        reverse_map_.reserve(n);
+        reserve_slots(n);
+    }
+
+    // Functions for accessing and modifying the size of the slots container.
+    // These are beneficial as allocating more slots than values will cause the
+    // generation counter increases to be more evenly distributed across the slots.
+    //
+    void reserve_slots(size_type n) {
+        key_index_type original_num_slots = static_cast<key_index_type>(slots_.size());
+        if (original_num_slots < n) {
+            slot_map_key_detail::check_new_slot_index<key_type>(n - 1);
+            slots_.reserve(n);
+            slots_.emplace_back(key_type{next_available_slot_index_, key_generation_type{}});
+            key_index_type last_new_slot = original_num_slots;
+            --n;
+            while (last_new_slot != n) {
+                slots_.emplace_back(key_type{last_new_slot, key_generation_type{}});
+                ++last_new_slot;
+            }
+            next_available_slot_index_ = last_new_slot;
+        }
+    }
+    size_type slot_count() const { return slots_.size(); }
+
+    // emplace() takes either no arguments, value-initializing every column,
+    // or exactly one argument per column, from which that column's value
+    // is constructed.
+    // O(1) amortized time and space complexity.
+    //
+    key_type emplace() {
+        append_guard guard(*this);
+        soa_slot_map_detail::for_each_index([&](auto i) { std::get<decltype(i)::value>(columns_).emplace_back(); }, indices{});
+        return this->link_new_value();
+    }
+    template<class U, class... Us>
+    key_type emplace(U&& u, Us&&... us) {
+        static_assert(1 + sizeof...(Us) == sizeof...(Ts), "emplace() takes one argument per column");
+        append_guard guard(*this);
+        this->emplace_columns(indices{}, std::forward<U>(u), std::forward<Us>(us)...);
+        return this->link_new_value();
+    }
+    key_type insert(const value_type& value) { return this->insert_tuple(value, indices{}); }
+    key_type insert(value_type&& value) { return this->insert_tuple(std::move(value), indices{}); }
+
+    // Each erase() version has an O(1) time complexity per value
+    // and O(1) space complexity.
+    //
+    iterator erase(const_iterator pos) {
+        size_type value_index = pos.index();
+        this->erase_slot(reverse_map_[value_index]);
+        return begin() + value_index;
+    }
+    size_type erase(const key_type& key) {
+        size_type value_index = this->value_index(key);
+        if (value_index == size()) {
+            return 0;
+        }
+        this->erase_slot(reverse_map_[value_index]);
+        return 1;
+    }
+
+    // clear() has O(n) time complexity and O(1) space complexity.
+    // As with slot_map, it also resets the generation counter of every slot.
+    //
+    void clear() {
+        soa_slot_map_detail::for_each_index([&](auto i) { std::get<decltype(i)::value>(columns_).clear(); }, indices{});
+        slots_.clear();
+        reverse_map_.clear();
+        next_available_slot_index_ = key_index_type{};
+        last_available_slot_index_ = key_index_type{};
+    }
+
+    void swap(basic_soa_slot_map& rhs) {
+        using std::swap;
+        swap(slots_, rhs.slots_);
+        swap(columns_, rhs.columns_);
+        swap(reverse_map_, rhs.reverse_map_);
+        swap(next_available_slot_index_, rhs.next_available_slot_index_);
+        swap(last_available_slot_index_, rhs.last_available_slot_index_);
+    }
+
+private:
+    // Checks that a new value can get a slot, lets the caller append it to
+    // each column in turn, and on destruction pops the values appended to
+    // the columns that were never linked to a slot, so that a constructor
+    // throwing part way through leaves every column as it was.
+    class append_guard {
+    public:
+        explicit append_guard(basic_soa_slot_map& sm) : sm_(sm) {
+            if (sm_.next_available_slot_index_ == sm_.slots_.size()) {
+                slot_map_key_detail::check_new_slot_index<key_type>(sm_.slots_.size());
+            }
+        }
+        append_guard(const append_guard&) = delete;
+        append_guard& operator=(const append_guard&) = delete;
+        ~append_guard() {
+            soa_slot_map_detail::for_each_index([&](auto i) {
+                auto& col = std::get<decltype(i)::value>(sm_.columns_);
+                while (col.size() > sm_.reverse_map_.size()) {
+                    col.pop_back();
+                }
+            }, indices{});
+        }
+
+    private:
+        basic_soa_slot_map& sm_;
+    };
+
+    template<std::size_t... Is>
+    std::tuple<Ts*...> column_pointers(std::index_sequence<Is...>) { return std::tuple<Ts*...>(std::get<Is>(columns_).data()...); }
+    template<std::size_t... Is>
+    std::tuple<const Ts*...> column_pointers(std::index_sequence<Is...>) const { return std::tuple<const Ts*...>(std::get<Is>(columns_).data()...); }
+
+    template<std::size_t... Is, class... Us>
+    void emplace_columns(std::index_sequence<Is...>, Us&&... us) {
+        (void)std::initializer_list<int>{ (std::get<Is>(columns_).emplace_back(std::forward<Us>(us)), 0)... };
+    }
+    template<class Tuple, std::size_t... Is>
+    key_type insert_tuple(Tuple&& value, std::index_sequence<Is...>) {
+        return this->emplace(std::get<Is>(std::forward<Tuple>(value))...);
+    }
+
+    // Returns size() if the key is out of range or expired.
+    size_type value_index(const key_type& key) const {
+        auto slot_index = get_index(key);
+        if (slot_index >= slots_.size() || get_generation(slots_[slot_index]) != get_generation(key)) {
+            return size();
+        }
+        return get_index(slots_[slot_index]);
+    }
+    size_type value_index_or_throw(const key_type& key) const {
+        size_type result = this->value_index(key);
+        if (result == size()) {
+            SLOT_MAP_THROW_EXCEPTION(std::out_of_range, "at");
+        }
+        return result;
+    }
+
+    // The new value has already been appended to every column. If this
+    // throws, the new slot is left on the free list and nothing else changes.
+    key_type link_new_value() {
+        auto value_pos = reverse_map_.size();
+        if (next_available_slot_index_ == slots_.size()) {
+            auto idx = next_available_slot_index_; ++idx;
+            slots_.emplace_back(key_type{idx, key_generation_type{}});  // make a new slot
+            last_available_slot_index_ = next_available_slot_index_;
+        }
+        reverse_map_.emplace_back(next_available_slot_index_);
+        auto slot_index = next_available_slot_index_;
+        key_type& slot = slots_[slot_index];
+        if (next_available_slot_index_ == last_available_slot_index_) {
+            next_available_slot_index_ = static_cast<key_index_type>(slots_.size());
+            last_available_slot_index_ = next_available_slot_index_;
+        } else {
+            next_available_slot_index_ = this->get_index(slot);
+        }
+        this->set_index(slot, value_pos);
+        key_type result = slot;
+        this->set_index(result, slot_index);
+        return result;
+    }
+
+    void erase_slot(size_type slot_index) {
+        size_type value_index = get_index(slots_[slot_index]);
+        size_type back_index = size() - 1;
+        if (value_index != back_index) {
+            soa_slot_map_detail::for_each_index([&](auto i) {
+                auto& col = std::get<decltype(i)::value>(columns_);
+                col[value_index] = std::move(col[back_index]);
+            }, indices{});
+            auto back_slot_index = reverse_map_[back_index];
+            this->set_index(slots_[back_slot_index], value_index);
+            reverse_map_[value_index] = back_slot_index;
+        }
+        soa_slot_map_detail::for_each_index([&](auto i) { std::get<decltype(i)::value>(columns_).pop_back(); }, indices{});
+        reverse_map_.pop_back();
+        // Expire this key.
+        if (next_available_slot_index_ == slots_.size()) {
+            next_available_slot_index_ = static_cast<key_index_type>(slot_index);
+            last_available_slot_index_ = static_cast<key_index_type>(slot_index);
+        } else {
+            this->set_index(slots_[last_available_slot_index_], slot_index);
+            last_available_slot_index_ = static_cast<key_index_type>(slot_index);
+        }
+        this->increment_generation(slots_[slot_index]);
+    }
+
+    std::vector<key_type> slots_;  // high_water_mark() entries
+    std::vector<key_index_type> reverse_map_;  // exactly size() entries
+    std::tuple<std::vector<Ts>...> columns_;  // exactly size() entries each
+    key_index_type next_available_slot_index_{};
+    key_index_type last_available_slot_index_{};
+};
+
+template<class... Ts>
+using soa_slot_map = basic_soa_slot_map<std::pair<unsigned, unsigned>, Ts...>;
+
+template<class Key, class... Ts>
+void swap(basic_soa_slot_map<Key, Ts...>& lhs, basic_soa_slot_map<Key, Ts...>& rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace stdext
@@ -5,12 +5,19 @@
 
 namespace sg14_test
 {
+    void buffered_flat_map_test();
+    void concurrent_slot_map_test();
+    void double_mapped_ring_test();
     void flat_map_test();
     void flat_set_test();
+    void front_coded_strings_test();
+    void frozen_flat_map_test();
+    void frozen_flat_set_test();
     void inplace_function_test();
     void plf_colony_test();
     void ring_test();
     void slot_map_test();
+    void soa_slot_map_test();
     void uninitialized_test();
     void unstable_remove_test();
 }
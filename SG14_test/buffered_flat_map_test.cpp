@@ -0,0 +1,198 @@
+#include "SG14_test.h"
+#include "buffered_flat_map.h"
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+template<class BM, class Model>
+static void CheckSame(const BM& bm, const Model& model)
+{
+    assert(bm.size() == model.size());
+    assert(std::equal(bm.begin(), bm.end(), model.begin(), model.end(), [](const typename BM::const_reference& a, const typename Model::value_type& b) {
+        return a.first == b.first && a.second == b.second;
+    }));
+    assert(std::equal(bm.rbegin(), bm.rend(), model.rbegin(), model.rend(), [](const typename BM::const_reference& a, const typename Model::value_type& b) {
+        return a.first == b.first && a.second == b.second;
+    }));
+}
+
+template<class Compare>
+static void ModelTest()
+{
+    using BM = stdext::buffered_flat_map<int, int, Compare>;
+    std::mt19937 g;
+    BM bm;
+    std::map<int, int, Compare> model;
+    size_t merges = 0;
+    for (int step = 0; step < 5000; ++step) {
+        int k = static_cast<int>(g() % 3000);
+        size_t buffered = bm.buffered_size();
+        switch (g() % 8) {
+            case 0: case 1: {
+                auto r = bm.try_emplace(k, step);
+                auto e = model.emplace(k, step);
+                assert(r.second == e.second);
+                assert(r.first->first == k && r.first->second == e.first->second);
+                break;
+            }
+            case 2:
+                bm[k] = step;
+                model[k] = step;
+                break;
+            case 3: {
+                auto r = bm.insert_or_assign(k, step);
+                assert(r.first->first == k && r.first->second == step);
+                model[k] = step;
+                break;
+            }
+            case 4:
+                assert(bm.erase(k) == model.erase(k));
+                break;
+            case 5: {
+                auto it = bm.find(k);
+                auto mt = model.find(k);
+                assert((it == bm.end()) == (mt == model.end()));
+                if (mt != model.end()) {
+                    // Erasing by iterator returns the next element.
+                    auto next = bm.erase(it);
+                    mt = model.erase(mt);
+                    assert((next == bm.end()) == (mt == model.end()));
+                    if (mt != model.end()) {
+                        assert(next->first == mt->first);
+                    }
+                }
+                break;
+            }
+            case 6: {
+                auto lo = bm.lower_bound(k);
+                auto hi = bm.upper_bound(k);
+                assert(std::distance(bm.begin(), lo) == std::distance(model.begin(), model.lower_bound(k)));
+                assert(std::distance(bm.begin(), hi) == std::distance(model.begin(), model.upper_bound(k)));
+                assert(bm.count(k) == model.count(k));
+                assert(bm.contains(k) == (model.count(k) != 0));
+                break;
+            }
+            default:
+                bm.emplace(k, -step);
+                model.emplace(k, -step);
+                break;
+        }
+        assert(bm.buffered_size() <= bm.merge_threshold());
+        merges += (bm.buffered_size() < buffered && bm.buffered_size() <= 1);
+        if (step % 97 == 0) {
+            CheckSame(bm, model);
+        }
+    }
+    assert(merges != 0);
+    CheckSame(bm, model);
+
+    // Bulk insertion and flush go through the main map.
+    std::vector<int> fresh(6000);
+    std::iota(fresh.begin(), fresh.end(), 0);
+    std::shuffle(fresh.begin(), fresh.end(), g);
+    std::vector<std::pair<int, int>> more;
+    for (int i = 0; i < 500; ++i) {
+        more.emplace_back(fresh[i], i);
+    }
+    bm.insert(more.begin(), more.end());
+    model.insert(more.begin(), more.end());
+    assert(bm.buffered_size() == 0);
+    CheckSame(bm, model);
+    bm.try_emplace(-1, 1);
+    model.emplace(-1, 1);
+    bm.flush();
+    assert(bm.buffered_size() == 0);
+    CheckSame(bm, model);
+    assert(bm.at(-1) == 1);
+
+    const BM copy = bm;
+    assert(copy == bm);
+    assert(copy.find(-1)->second == 1);
+    bm.clear();
+    assert(bm.empty() && bm.begin() == bm.end() && copy != bm);
+}
+
+static void IteratorTest()
+{
+    stdext::buffered_flat_map<std::string, int> bm = {{"b", 2}, {"d", 4}};
+    bm.try_emplace("a", 1);
+    bm.try_emplace("c", 3);
+    bm.try_emplace("e", 5);
+    assert(bm.buffered_size() == 3);
+    std::string keys;
+    for (auto&& kv : bm) {
+        keys += kv.first;
+        kv.second *= 10;
+    }
+    assert(keys == "abcde");
+    assert(bm["c"] == 30 && bm.at("d") == 40);
+    stdext::buffered_flat_map<std::string, int>::const_iterator it = bm.end();
+    --it;
+    assert(it->first == "e");
+    --it;
+    --it;
+    assert(it->first == "c");
+    it++;
+    assert((*it).first == "d");
+    auto range = bm.equal_range("b");
+    assert(std::distance(range.first, range.second) == 1 && range.first->second == 20);
+}
+
+#if defined(SG14_BENCHMARKS)
+static void InsertBenchmark()
+{
+    std::mt19937 g;
+    std::vector<int> keys(100000);
+    for (int& k : keys) {
+        k = static_cast<int>(g());
+    }
+    stdext::flat_map<int, int> fm;
+    stdext::buffered_flat_map<int, int> bm;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int k : keys) {
+        fm.try_emplace(k, k);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int k : keys) {
+        bm.try_emplace(k, k);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    size_t found = 0;
+    for (int k : keys) {
+        found += bm.contains(k);
+    }
+    auto t3 = std::chrono::high_resolution_clock::now();
+    assert(found == keys.size() && bm.size() == fm.size());
+    printf("%zu random inserts: flat_map %lld, buffered_flat_map %lld; buffered lookups %lld\n",
+        keys.size(), (long long)(t1 - t0).count(), (long long)(t2 - t1).count(), (long long)(t3 - t2).count());
+}
+#endif
+
+} // anonymous namespace
+
+void sg14_test::buffered_flat_map_test()
+{
+    ModelTest<std::less<int>>();
+    ModelTest<std::greater<int>>();
+    IteratorTest();
+#if defined(SG14_BENCHMARKS)
+    InsertBenchmark();
+#endif
+}
+
+#ifdef TEST_MAIN
+int main()
+{
+    sg14_test::buffered_flat_map_test();
+}
+#endif
@@ -0,0 +1,187 @@
+#include "SG14_test.h"
+#include "concurrent_slot_map.h"
+#include <assert.h>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Payload {
+    explicit Payload(unsigned v) : value(v), check(~v) {}
+    ~Payload() { value = 0xdeadbeef; check = 0xdeadbeef; }
+    bool intact() const { return check == ~value; }
+    unsigned value;
+    unsigned check;
+};
+
+} // namespace
+
+static void BasicTest()
+{
+    using SM = stdext::concurrent_slot_map<int>;
+    SM sm;
+    assert(sm.empty());
+    auto k1 = sm.insert(42);
+    auto k2 = sm.emplace(37);
+    assert(sm.size() == 2);
+    assert(sm.slot_count() >= 2);
+    assert(*sm.find(k1) == 42);
+
+    auto r = sm.make_reader();
+    {
+        auto g = r.pin();
+        assert(*g.find(k1) == 42);
+        assert(*g.find(k2) == 37);
+
+        const int *p = g.find(k1);
+        assert(sm.erase(k1) == 1);
+        assert(g.find(k1) == nullptr);  // the key is expired...
+        assert(*p == 42);               // ...but the value outlives our pin
+        sm.reclaim();
+        assert(sm.retired_count() == 1);
+        assert(*p == 42);
+    }
+    sm.reclaim();
+    assert(sm.retired_count() == 0);
+
+    assert(sm.erase(k1) == 0);
+    assert(sm.find(k1) == nullptr);
+    assert(sm.size() == 1);
+
+    auto k3 = sm.insert(5);
+    assert(sm.find(k1) == nullptr);
+    assert(*r.pin().find(k3) == 5);
+    assert(r.pin().contains(k2));
+}
+
+static void GrowthTest()
+{
+    using SM = stdext::concurrent_slot_map<int>;
+    SM sm;
+    std::vector<SM::key_type> keys;
+    for (int i = 0; i < 10000; ++i) {
+        keys.push_back(sm.insert(i));
+    }
+    auto r = sm.make_reader();
+    auto g = r.pin();
+    for (int i = 0; i < 10000; ++i) {
+        assert(*g.find(keys[i]) == i);
+    }
+    assert(g.find(SM::key_type{(unsigned)sm.slot_count(), 0}) == nullptr);
+}
+
+static void UnissuedKeyTest()
+{
+    using SM = stdext::concurrent_slot_map<int>;
+    SM sm;
+    auto k1 = sm.insert(1);
+    assert(sm.slot_count() > 1);
+
+    // A slot that grow() made but insert never issued has generation 0.
+    assert(sm.erase(SM::key_type{k1.first + 1, 0}) == 0);
+    assert(sm.size() == 1);
+
+    // An erased slot's new generation has not been issued either.
+    assert(sm.erase(k1) == 1);
+    assert(sm.erase(SM::key_type{k1.first, k1.second + 1}) == 0);
+    assert(sm.empty());
+    assert(sm.retired_count() == 1);
+
+    // Every free slot is handed out exactly once.
+    std::vector<SM::key_type> keys;
+    for (int i = 0; i < (int)sm.slot_count(); ++i) {
+        keys.push_back(sm.insert(i));
+    }
+    assert(sm.size() == keys.size());
+    for (int i = 0; i < (int)keys.size(); ++i) {
+        assert(*sm.find(keys[i]) == i);
+    }
+}
+
+static void ReaderRegistrationTest()
+{
+    using SM = stdext::concurrent_slot_map<int>;
+    SM sm(2);
+    {
+        auto r1 = sm.make_reader();
+        auto r2 = sm.make_reader();
+        try { (void)sm.make_reader(); assert(false); } catch (const std::length_error&) {}
+    }
+    auto r3 = sm.make_reader();  // registrations are released on destruction
+    (void)r3;
+}
+
+static void ConcurrentReadersTest()
+{
+    using SM = stdext::concurrent_slot_map<Payload>;
+    SM sm;
+    const int num_published = 256;
+    std::atomic<std::uint64_t> published[num_published];
+    auto publish_new = [&](std::atomic<std::uint64_t>& p) {
+        SM::key_type k = sm.emplace(0u);
+        // The writer may modify a value before publishing its key.
+        *sm.find(k) = Payload(k.first * 1000 + k.second);
+        p.store((std::uint64_t(k.first) << 32) | k.second);
+    };
+    for (auto&& p : published) {
+        publish_new(p);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<long> hits{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&, t]() {
+            auto reader = sm.make_reader();
+            std::mt19937 g(t);
+            while (!done.load()) {
+                auto guard = reader.pin();
+                for (int i = 0; i < 64; ++i) {
+                    std::uint64_t packed = published[g() % num_published].load();
+                    SM::key_type k{unsigned(packed >> 32), unsigned(packed)};
+                    if (const Payload *p = guard.find(k)) {
+                        assert(p->intact());
+                        assert(p->value == k.first * 1000 + k.second);
+                        ++hits;
+                    }
+                }
+            }
+        });
+    }
+
+    std::mt19937 g;
+    for (int i = 0; i < 20000; ++i) {
+        auto& p = published[g() % num_published];
+        std::uint64_t packed = p.load();
+        SM::key_type old{unsigned(packed >> 32), unsigned(packed)};
+        assert(sm.erase(old) == 1);
+        publish_new(p);
+    }
+    done = true;
+    for (auto&& t : readers) {
+        t.join();
+    }
+    sm.reclaim();
+    assert(sm.retired_count() == 0);
+    assert(sm.size() == num_published);
+    (void)hits;
+}
+
+void sg14_test::concurrent_slot_map_test()
+{
+    BasicTest();
+    GrowthTest();
+    UnissuedKeyTest();
+    ReaderRegistrationTest();
+    ConcurrentReadersTest();
+}
+
+#ifdef TEST_MAIN
+int main()
+{
+    sg14_test::concurrent_slot_map_test();
+}
+#endif
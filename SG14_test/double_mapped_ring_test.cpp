@@ -0,0 +1,73 @@
+#include "SG14_test.h"
+
+#include "double_mapped_ring.h"
+
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+static void mirror_test()
+{
+    sg14::double_mapped_buffer buf(1);
+    assert(buf.size() > 0);
+    assert(buf.end() - buf.begin() == static_cast<std::ptrdiff_t>(buf.size()));
+
+    buf.begin()[0] = 'x';
+    assert(buf.end()[0] == 'x');
+    buf.end()[1] = 'y';
+    assert(buf.begin()[1] == 'y');
+
+    sg14::double_mapped_buffer buf2(std::move(buf));
+    assert(buf2.begin()[0] == 'x');
+}
+
+static void contiguous_ring_test()
+{
+    sg14::double_mapped_buffer buf(4096);
+    const std::size_t cap = buf.size();
+
+    // Start three bytes before the end so every access straddles the wrap.
+    sg14::ring_span<char> r(buf.begin(), buf.end(), buf.end() - 3, 0);
+
+    auto w = sg14::contiguous_writable(r);
+    assert(w.size() == cap);
+    std::memcpy(w.data(), "hello, world", 12);
+    r.commit_back(12);
+    assert(std::string(r.begin(), r.end()) == "hello, world");
+    assert(std::string(buf.begin(), 9) == "lo, world");
+
+    auto rd = sg14::contiguous_readable(r);
+    assert(rd.size() == 12);
+    assert(std::string(rd.data(), rd.size()) == "hello, world");
+    r.drop_front(7);
+
+    rd = sg14::contiguous_readable(r);
+    assert(std::string(rd.begin(), rd.end()) == "world");
+
+    w = sg14::contiguous_writable(r);
+    assert(w.size() == cap - 5);
+    std::memset(w.data(), '!', w.size());
+    r.commit_back(w.size());
+    assert(r.full());
+    rd = sg14::contiguous_readable(r);
+    assert(rd.size() == cap);
+    assert(std::string(rd.data(), 6) == "world!");
+    assert(rd.data()[cap - 1] == '!');
+}
+#endif
+
+void sg14_test::double_mapped_ring_test()
+{
+#if defined(__linux__)
+    mirror_test();
+    contiguous_ring_test();
+#endif
+}
+
+#ifdef TEST_MAIN
+int main()
+{
+    sg14_test::double_mapped_ring_test();
+}
+#endif
@@ -1,13 +1,26 @@
 #include "SG14_test.h"
 #include "flat_map.h"
 #include <assert.h>
+#include <cmath>
+#include <chrono>
 #include <deque>
 #include <functional>
+#include <iterator>
 #include <list>
+#include <map>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <sstream>
 #if __has_include(<memory_resource>)
 #include <memory_resource>
 #endif
+#include <random>
+#include <stdio.h>
 #include <string>
+#if __has_include(<string_view>)
+#include <string_view>
+#endif
 #include <vector>
 
 namespace {
@@ -26,6 +39,20 @@ private:
     std::string s_;
 };
 
+// A key whose move constructor throws once moves_left() runs out.
+struct FragileKey {
+    static int& moves_left() { static int n = -1; return n; }
+    FragileKey(int v) : value(v) {}
+    FragileKey(const FragileKey&) = default;
+    FragileKey(FragileKey&& rhs) : value(rhs.value) {
+        if (moves_left()-- == 0) throw std::bad_alloc();
+    }
+    FragileKey& operator=(const FragileKey&) = default;
+    FragileKey& operator=(FragileKey&&) = default;
+    friend bool operator<(const FragileKey& a, const FragileKey& b) { return a.value < b.value; }
+    int value;
+};
+
 struct InstrumentedWidget {
     static int move_ctors, copy_ctors;
     InstrumentedWidget() = delete;
@@ -202,6 +229,350 @@ static void TryEmplaceTest()
     }
 }
 
+static void BranchlessSearchTest()
+{
+    // unsigned keys above 2^31 exercise the sign-bit flip of the SIMD scan.
+    stdext::flat_map<unsigned, int> fm;
+    std::map<unsigned, int> m;
+    std::mt19937 g;
+    for (int i = 0; i < 3000; ++i) {
+        unsigned k = g() | (i % 2 ? 0x80000000u : 0u);
+        auto r1 = fm.try_emplace(k, i);
+        auto r2 = m.emplace(k, i);
+        assert(r1.second == r2.second);
+        assert(r1.first - fm.begin() == std::distance(m.begin(), r2.first));
+        if (i % 3 == 0) {
+            auto key = g();
+            assert(fm.count(key) == m.count(key));
+            assert(fm.lower_bound(key) - fm.begin() == std::distance(m.begin(), m.lower_bound(key)));
+            assert(fm.upper_bound(key) - fm.begin() == std::distance(m.begin(), m.upper_bound(key)));
+        }
+    }
+    for (auto&& kv : m) {
+        assert(fm.at(kv.first) == kv.second);
+        auto range = fm.equal_range(kv.first);
+        assert(range.second - range.first == 1 && range.first->second == kv.second);
+    }
+}
+
+static void BulkInsertTest()
+{
+    // Merge random batches, with duplicates inside each batch and against
+    // the map, and compare with std::map::insert.
+    stdext::flat_map<int, int> fm;
+    std::map<int, int> m;
+    std::mt19937 g;
+    for (int round = 0; round < 30; ++round) {
+        std::vector<std::pair<int, int>> batch;
+        size_t n = g() % 500;
+        int range = 1 + static_cast<int>(g() % 3000);
+        for (size_t i = 0; i < n; ++i) {
+            int k = static_cast<int>(g() % unsigned(range)) - 100;
+            batch.emplace_back(k, round);  // duplicates in one batch agree on the value
+        }
+        if (round % 3 == 0) {
+            std::sort(batch.begin(), batch.end());
+            batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+            fm.insert(stdext::sorted_unique, batch.begin(), batch.end());
+        } else {
+            fm.insert(batch.begin(), batch.end());
+        }
+        m.insert(batch.begin(), batch.end());
+        assert(fm.size() == m.size());
+        assert(std::equal(fm.begin(), fm.end(), m.begin(), m.end(), [](const auto& a, const auto& b) {
+            return a.first == b.first && a.second == b.second;
+        }));
+    }
+
+    // An input range of a type merely convertible to the value_type.
+    std::vector<std::pair<short, long>> converted = {{7, 70}, {-5, -50}, {7, 71}};
+    stdext::flat_map<int, long, std::greater<int>> desc{{0, 0}};
+    desc.insert(converted.begin(), converted.end());
+    assert(desc.size() == 3 && desc.begin()->first == 7 && std::prev(desc.end())->second == -50);
+
+    // Failing to buffer the new keys for the merge drops only the new keys.
+    stdext::flat_map<FragileKey, int> fragile;
+    for (int i = 0; i < 100; i += 2) {
+        fragile.emplace(i, i);
+    }
+    std::vector<std::pair<FragileKey, int>> odd;
+    for (int i = 1; i < 20; i += 2) {
+        odd.emplace_back(i, i);
+    }
+    auto containers = std::move(fragile).extract();
+    containers.keys.reserve(200);
+    containers.values.reserve(200);
+    fragile.replace(std::move(containers.keys), std::move(containers.values));
+    FragileKey::moves_left() = static_cast<int>(odd.size());  // enough to append them
+    bool threw = false;
+    try {
+        fragile.insert(stdext::sorted_unique, odd.begin(), odd.end());
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    FragileKey::moves_left() = -1;
+    assert(threw && fragile.size() == 50);
+    for (int i = 0; i < 100; i += 2) {
+        assert(fragile.at(i) == i);
+    }
+}
+
+#if defined(SG14_BENCHMARKS)
+static void BulkInsertBenchmark()
+{
+    const int n = 1000000;
+    std::mt19937 g;
+    std::vector<std::pair<int, int>> base, batch, small(10000);
+    for (int i = 0; i < n; ++i) {
+        base.emplace_back(static_cast<int>(g()), i);
+        batch.emplace_back(static_cast<int>(g()), -i);
+    }
+    for (auto&& kv : small) {
+        kv = {static_cast<int>(g()), 0};
+    }
+    stdext::flat_map<int, int> fm(base.begin(), base.end());
+    stdext::flat_map<int, int> fm2 = fm;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (auto&& kv : small) {
+        fm2.insert(kv);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    fm.insert(batch.begin(), batch.end());
+    auto t2 = std::chrono::high_resolution_clock::now();
+    assert(std::is_sorted(fm.keys().begin(), fm.keys().end()));
+    printf("flat_map of %d: %zu single inserts %lld, bulk insert of %d %lld\n", n, small.size(),
+        (long long)(t1 - t0).count(), n, (long long)(t2 - t1).count());
+}
+#endif
+
+static std::vector<int> make_pattern(int pattern, int n, std::mt19937& g)
+{
+    std::vector<int> v(n);
+    for (int i = 0; i < n; ++i) {
+        switch (pattern) {
+            case 0: v[i] = i; break;                                   // sorted
+            case 1: v[i] = n - i; break;                               // reverse-sorted
+            case 2: v[i] = static_cast<int>(g() % 8); break;           // many duplicates
+            case 3: v[i] = (i < n / 2) ? i : n - i; break;             // organ pipe
+            case 4: v[i] = (i % 2) ? i : n - i; break;                 // interleaved
+            case 5: v[i] = 42; break;                                  // all equal
+            default: v[i] = static_cast<int>(g()); break;              // random
+        }
+    }
+    return v;
+}
+
+static void SortTogetherTest()
+{
+    // Keys and values must be permuted together, without quadratic blowup
+    // on any of the patterned inputs.
+    std::mt19937 g;
+    for (int pattern = 0; pattern < 7; ++pattern) {
+        for (int n : {0, 1, 2, 3, 15, 16, 17, 100, 129, 1000, 20000}) {
+            std::vector<int> keys = make_pattern(pattern, n, g);
+            std::vector<int> original = keys;
+            std::vector<int> values(n);
+            std::iota(values.begin(), values.end(), 0);
+            size_t comparisons = 0;
+            auto less = [&](int a, int b) { ++comparisons; return a < b; };
+            stdext::flatmap_detail::sort_together(less, keys, values);
+            assert(std::is_sorted(keys.begin(), keys.end()));
+            for (int i = 0; i < n; ++i) {
+                assert(original[values[i]] == keys[i]);
+            }
+            std::sort(values.begin(), values.end());
+            for (int i = 0; i < n; ++i) {
+                assert(values[i] == i);
+            }
+            assert(n < 2 || comparisons < 4 * size_t(n) * size_t(std::log2(n) + 1));
+        }
+    }
+}
+
+#if defined(SG14_BENCHMARKS)
+static void SortTogetherBenchmark()
+{
+    const char *names[] = {"sorted", "reverse", "duplicates", "organ pipe", "interleaved", "all equal", "random"};
+    const int n = 1000000;
+    std::mt19937 g;
+    for (int pattern = 0; pattern < 7; ++pattern) {
+        std::vector<int> keys = make_pattern(pattern, n, g);
+        std::vector<int> values(n);
+        auto t0 = std::chrono::high_resolution_clock::now();
+        stdext::flat_map<int, int> fm(std::move(keys), std::move(values));
+        auto t1 = std::chrono::high_resolution_clock::now();
+        assert(std::is_sorted(fm.keys().begin(), fm.keys().end()));
+        printf("flat_map construction from %d %s keys: %lld\n", n, names[pattern], (long long)(t1 - t0).count());
+    }
+}
+#endif
+
+static void FindManyTest()
+{
+    stdext::flat_map<int, int> fm;
+    for (int i = 0; i < 5000; ++i) {
+        fm.emplace(3 * i, i);
+    }
+    const auto& cfm = fm;
+    std::mt19937 g;
+    for (int round = 0; round < 4; ++round) {
+        std::vector<int> probes;
+        for (int i = 0; i < 1000; ++i) {
+            probes.push_back(static_cast<int>(g() % 16000) - 500);
+        }
+        if (round % 2 == 0) {
+            std::sort(probes.begin(), probes.end());
+        }
+        std::vector<stdext::flat_map<int, int>::iterator> found;
+        fm.find_many(probes.begin(), probes.end(), std::back_inserter(found));
+        std::vector<stdext::flat_map<int, int>::const_iterator> cfound(probes.size());
+        auto cend = cfm.find_many(probes.begin(), probes.end(), cfound.begin());
+        assert(cend == cfound.end() && found.size() == probes.size());
+        std::vector<bool> present;
+        cfm.contains_many(probes.begin(), probes.end(), std::back_inserter(present));
+        size_t expected_count = 0;
+        for (size_t i = 0; i < probes.size(); ++i) {
+            assert(found[i] == fm.find(probes[i]));
+            assert(cfound[i] == found[i]);
+            assert(present[i] == fm.contains(probes[i]));
+            expected_count += fm.count(probes[i]);
+        }
+        assert(fm.count_many(probes.begin(), probes.end()) == expected_count);
+    }
+
+    // Single-pass probes are handled too, sorted or not.
+    std::istringstream in("3 6 7 9 9 0 14997 15000");
+    std::vector<bool> present;
+    fm.contains_many(std::istream_iterator<int>(in), std::istream_iterator<int>(), std::back_inserter(present));
+    assert((present == std::vector<bool>{true, true, false, true, true, true, true, false}));
+    stdext::flat_map<int, int> empty;
+    std::vector<int> some = {5, 1, 3};
+    assert(empty.count_many(some.begin(), some.end()) == 0);
+}
+
+static size_t g_allocations = 0;
+
+template<class T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() = default;
+    template<class U> CountingAllocator(const CountingAllocator<U>&) {}
+    T *allocate(size_t n) { ++g_allocations; return std::allocator<T>().allocate(n); }
+    void deallocate(T *p, size_t n) { std::allocator<T>().deallocate(p, n); }
+    friend bool operator==(const CountingAllocator&, const CountingAllocator&) { return true; }
+    friend bool operator!=(const CountingAllocator&, const CountingAllocator&) { return false; }
+};
+
+using counted_string = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+// Orders strings as usual, and a char against the first character of a
+// string, so that one char is equivalent to a run of keys.
+struct FirstCharLess {
+    using is_transparent = void;
+    bool operator()(const std::string& a, const std::string& b) const { return a < b; }
+    bool operator()(const std::string& a, char b) const { return a[0] < b; }
+    bool operator()(char a, const std::string& b) const { return a < b[0]; }
+};
+
+static void HeterogeneousLookupTest()
+{
+    // Keys too long for the small-string buffer: a temporary key would
+    // allocate, and the lookups below must not make one.
+    const char *long_keys[] = {
+        "/api/v1/handlers/alpha-long-enough",
+        "/api/v1/handlers/bravo-long-enough",
+        "/api/v1/handlers/charlie-long-enough",
+    };
+    stdext::flat_map<counted_string, int, std::less<>> fm;
+    for (int i = 0; i < 3; ++i) {
+        fm.emplace(long_keys[i], i);
+    }
+    const auto& cfm = fm;
+    g_allocations = 0;
+    const char *k = long_keys[1];
+    assert(fm.find(k)->second == 1);
+    assert(cfm.find(k)->second == 1);
+    assert(fm.find("/api/v1/handlers/delta-long-enough") == fm.end());
+    assert(fm.lower_bound(k) - fm.begin() == 1);
+    assert(cfm.upper_bound(k) - cfm.begin() == 2);
+    assert(fm.equal_range(k).first->second == 1);
+    assert(cfm.equal_range(k).second - cfm.begin() == 2);
+    assert(fm.count(k) == 1);
+    assert(fm.contains(long_keys[2]));
+    assert(!fm.contains("/api"));
+#if defined(__cpp_lib_string_view)
+    std::string_view sv = long_keys[2];
+    assert(fm.find(sv)->second == 2);
+    assert(fm.count(sv) == 1);
+    assert(fm.erase(sv) == 1);
+    assert(fm.erase(sv) == 0);
+    assert(fm.size() == 2);
+#endif
+    assert(fm.erase(long_keys[0]) == 1);
+    assert(g_allocations == 0);
+
+    // Without a transparent comparator, the same lookup converts the key.
+    stdext::flat_map<counted_string, int> opaque;
+    opaque.emplace(long_keys[1], 1);
+    g_allocations = 0;
+    assert(opaque.find(k)->second == 1);
+    assert(g_allocations != 0);
+
+    // A heterogeneous key may be equivalent to several keys.
+    stdext::flat_map<std::string, int, FirstCharLess> fc;
+    for (const char *s : {"apple", "banana", "blueberry", "cherry", "cranberry", "currant"}) {
+        fc.emplace(s, s[1]);
+    }
+    assert(fc.count('b') == 2);
+    assert(fc.count('c') == 3);
+    assert(fc.count('d') == 0);
+    assert(fc.contains('a'));
+    assert(fc.find('c')->first == "cherry");
+    auto r = fc.equal_range('b');
+    assert(r.first->first == "banana" && r.second->first == "cherry");
+    assert(fc.lower_bound('c')->first == "cherry");
+    assert(fc.upper_bound('a')->first == "banana");
+    assert(fc.erase('c') == 3);
+    assert(fc.erase('c') == 0);
+    assert(fc.size() == 3);
+    assert(fc.find(std::string("blueberry"))->second == 'l');
+}
+
+#if defined(SG14_BENCHMARKS)
+static void FindManyBenchmark()
+{
+    const int n = 1000000;
+    const int m = 100000;
+    stdext::flat_map<int, int> fm;
+    std::vector<int> keys(n), values(n);
+    for (int i = 0; i < n; ++i) {
+        keys[i] = 2 * i;
+    }
+    fm.replace(std::move(keys), std::move(values));
+    std::mt19937 g;
+    std::vector<int> probes(m);
+    for (int& x : probes) {
+        x = static_cast<int>(g() % (2u * n));
+    }
+    for (int sorted = 0; sorted < 2; ++sorted) {
+        if (sorted) {
+            std::sort(probes.begin(), probes.end());
+        }
+        size_t count_loop = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int x : probes) {
+            count_loop += fm.count(x);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        size_t count_batch = fm.count_many(probes.begin(), probes.end());
+        auto t2 = std::chrono::high_resolution_clock::now();
+        assert(count_loop == count_batch);
+        printf("flat_map of %d, %d %s probes: count loop %lld, count_many %lld\n", n, m, sorted ? "sorted" : "unsorted",
+            (long long)(t1 - t0).count(), (long long)(t2 - t1).count());
+    }
+}
+#endif
+
 static void VectorBoolSanityTest()
 {
     using FM = stdext::flat_map<bool, bool>;
@@ -688,6 +1059,11 @@ void sg14_test::flat_map_test()
     MoveOperationsPilferOwnership();
     SortedUniqueConstructionTest();
     TryEmplaceTest();
+    BranchlessSearchTest();
+    BulkInsertTest();
+    SortTogetherTest();
+    FindManyTest();
+    HeterogeneousLookupTest();
     VectorBoolSanityTest();
     DeductionGuideTests();
 
@@ -752,6 +1128,12 @@ void sg14_test::flat_map_test()
         SearchTest<FS>();
     }
 #endif
+
+#if defined(SG14_BENCHMARKS)
+    BulkInsertBenchmark();
+    SortTogetherBenchmark();
+    FindManyBenchmark();
+#endif
 }
 
 #ifdef TEST_MAIN
@@ -1,12 +1,23 @@
 #include "SG14_test.h"
 #include "flat_set.h"
 #include <assert.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <deque>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
 #if __has_include(<memory_resource>)
 #include <memory_resource>
 #endif
+#include <random>
+#include <stdio.h>
 #include <string>
+#if __has_include(<string_view>)
+#include <string_view>
+#endif
 #include <vector>
 
 namespace {
@@ -275,6 +286,288 @@ static void SpecialMemberTest()
     static_assert(std::is_nothrow_destructible<FS>::value, "");
 }
 
+// Any comparator other than std::less takes the generic search path.
+struct PlainLess {
+    template<class T>
+    bool operator()(const T& a, const T& b) const { return a < b; }
+};
+
+template<class T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+static T random_key(std::mt19937& g)
+{
+    return T(int(g() % 20001) - 10000) / T(16);
+}
+
+template<class T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+static T random_key(std::mt19937& g)
+{
+    return static_cast<T>((std::uint64_t(g()) << 32) | g());
+}
+
+template<class T, class Compare>
+static void BranchlessSearchTest()
+{
+    // Check the fast search path against std::lower_bound, at sizes on
+    // both sides of its switch to a linear scan.
+    std::mt19937 g;
+    for (size_t n : {0, 1, 2, 3, 7, 16, 31, 32, 33, 64, 100, 255, 1000, 5000}) {
+        std::vector<T> pool = {std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max(), T(0)};
+        while (pool.size() < n) {
+            pool.push_back(random_key<T>(g));
+        }
+        stdext::flat_set<T, Compare> fs(pool);
+        const auto& cfs = fs;
+        std::vector<T> keys(fs.begin(), fs.end());
+        std::vector<T> probes(keys);
+        for (int i = 0; i < 200; ++i) {
+            probes.push_back(random_key<T>(g));
+        }
+        probes.push_back(std::numeric_limits<T>::lowest());
+        probes.push_back(std::numeric_limits<T>::max());
+        for (T x : probes) {
+            auto lo = std::lower_bound(keys.begin(), keys.end(), x) - keys.begin();
+            auto hi = std::upper_bound(keys.begin(), keys.end(), x) - keys.begin();
+            assert(fs.lower_bound(x) - fs.begin() == lo);
+            assert(cfs.lower_bound(x) - cfs.begin() == lo);
+            assert(fs.upper_bound(x) - fs.begin() == hi);
+            assert(cfs.upper_bound(x) - cfs.begin() == hi);
+            auto range = fs.equal_range(x);
+            assert(range.first - fs.begin() == lo && range.second - fs.begin() == hi);
+            assert(fs.contains(x) == (lo != hi));
+            assert((fs.find(x) == fs.end()) == (lo == hi));
+        }
+    }
+}
+
+static size_t g_allocations = 0;
+
+template<class T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() = default;
+    template<class U> CountingAllocator(const CountingAllocator<U>&) {}
+    T *allocate(size_t n) { ++g_allocations; return std::allocator<T>().allocate(n); }
+    void deallocate(T *p, size_t n) { std::allocator<T>().deallocate(p, n); }
+    friend bool operator==(const CountingAllocator&, const CountingAllocator&) { return true; }
+    friend bool operator!=(const CountingAllocator&, const CountingAllocator&) { return false; }
+};
+
+using counted_string = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+// Orders strings as usual, and a char against the first character of a
+// string, so that one char is equivalent to a run of keys.
+struct FirstCharLess {
+    using is_transparent = void;
+    bool operator()(const std::string& a, const std::string& b) const { return a < b; }
+    bool operator()(const std::string& a, char b) const { return a[0] < b; }
+    bool operator()(char a, const std::string& b) const { return a < b[0]; }
+};
+
+static void HeterogeneousLookupTest()
+{
+    // Keys too long for the small-string buffer: a temporary key would
+    // allocate, and the lookups below must not make one.
+    const char *long_keys[] = {
+        "/api/v1/handlers/alpha-long-enough",
+        "/api/v1/handlers/bravo-long-enough",
+        "/api/v1/handlers/charlie-long-enough",
+    };
+    stdext::flat_set<counted_string, std::less<>> fs;
+    for (const char *s : long_keys) {
+        fs.emplace(s);
+    }
+    const auto& cfs = fs;
+    g_allocations = 0;
+    const char *k = long_keys[1];
+    assert(fs.find(k) - fs.begin() == 1);
+    assert(cfs.find(k) - cfs.begin() == 1);
+    assert(fs.find("/api/v1/handlers/delta-long-enough") == fs.end());
+    assert(fs.lower_bound(k) - fs.begin() == 1);
+    assert(cfs.upper_bound(k) - cfs.begin() == 2);
+    assert(fs.equal_range(k).first - fs.begin() == 1);
+    assert(cfs.equal_range(k).second - cfs.begin() == 2);
+    assert(fs.count(k) == 1);
+    assert(fs.contains(long_keys[2]));
+    assert(!fs.contains("/api"));
+#if defined(__cpp_lib_string_view)
+    std::string_view sv = long_keys[2];
+    assert(fs.find(sv) - fs.begin() == 2);
+    assert(fs.count(sv) == 1);
+    assert(fs.erase(sv) == 1);
+    assert(fs.erase(sv) == 0);
+    assert(fs.size() == 2);
+#endif
+    assert(fs.erase(long_keys[0]) == 1);
+    assert(g_allocations == 0);
+
+    // Without a transparent comparator, the same lookup converts the key.
+    stdext::flat_set<counted_string> opaque;
+    opaque.emplace(long_keys[1]);
+    g_allocations = 0;
+    assert(opaque.find(k) == opaque.begin());
+    assert(g_allocations != 0);
+
+    // A heterogeneous key may be equivalent to several keys.
+    stdext::flat_set<std::string, FirstCharLess> fc = {"apple", "banana", "blueberry", "cherry", "cranberry", "currant"};
+    assert(fc.count('b') == 2);
+    assert(fc.count('c') == 3);
+    assert(fc.count('d') == 0);
+    assert(fc.contains('a'));
+    assert(*fc.find('c') == "cherry");
+    auto r = fc.equal_range('b');
+    assert(*r.first == "banana" && *r.second == "cherry");
+    assert(*fc.lower_bound('c') == "cherry");
+    assert(*fc.upper_bound('a') == "banana");
+    assert(fc.erase('c') == 3);
+    assert(fc.erase('c') == 0);
+    assert(fc.size() == 3);
+}
+
+#if defined(SG14_BENCHMARKS)
+static void SearchBenchmark()
+{
+    std::mt19937 g;
+    std::vector<int> probes(1 << 18);
+    for (size_t n : {16, 256, 4096, 65536, 1 << 20, 10000000}) {
+        std::vector<int> keys(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = static_cast<int>(2 * i);
+        }
+        for (int& x : probes) {
+            x = static_cast<int>(g() % (2 * n));
+        }
+        stdext::flat_set<int> fast(stdext::sorted_unique, keys);
+        stdext::flat_set<int, PlainLess> generic(stdext::sorted_unique, keys);
+        size_t sum_fast = 0, sum_generic = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int x : probes) {
+            sum_generic += static_cast<size_t>(generic.lower_bound(x) - generic.begin());
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (int x : probes) {
+            sum_fast += static_cast<size_t>(fast.lower_bound(x) - fast.begin());
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        assert(sum_fast == sum_generic);
+        printf("flat_set<int>::lower_bound x%zu over %zu keys: generic %lld, branchless %lld\n", probes.size(), n,
+            (long long)(t1 - t0).count(), (long long)(t2 - t1).count());
+    }
+}
+#endif
+
+template<class FS, class Make>
+static FS random_set(std::mt19937& g, size_t n, Make make)
+{
+    typename FS::container_type keys;
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(make(static_cast<size_t>(g() % (2 * n + 1))));
+    }
+    return FS(keys);
+}
+
+#define SG14_SET_OP(name) \
+    struct name##_op { \
+        template<class FS> FS operator()(const FS& a, const FS& b) const { return stdext::name(a, b); } \
+        template<class FS> void operator()(const FS& a, const FS& b, FS& dest) const { stdext::name(a, b, dest); } \
+        template<class FS, class Out> void expected(const FS& a, const FS& b, Out out) const { \
+            std::name(a.begin(), a.end(), b.begin(), b.end(), out, a.key_comp()); \
+        } \
+    };
+SG14_SET_OP(set_union)
+SG14_SET_OP(set_intersection)
+SG14_SET_OP(set_difference)
+SG14_SET_OP(set_symmetric_difference)
+#undef SG14_SET_OP
+
+template<class FS, class Op>
+static void CheckSetOp(const FS& a, const FS& b, Op op)
+{
+    using Keys = std::vector<typename FS::key_type>;
+    Keys expected;
+    op.expected(a, b, std::back_inserter(expected));
+
+    FS result = op(a, b);
+    assert(Keys(result.begin(), result.end()) == expected);
+
+    // Out of place, into a set whose capacity is reused.
+    FS dest = a;
+    dest.insert(b.begin(), b.end());
+    auto *before = dest.empty() ? nullptr : &*dest.begin();
+    op(a, b, dest);
+    assert(Keys(dest.begin(), dest.end()) == expected);
+    if (!dest.empty() && std::is_same<typename FS::container_type, std::vector<typename FS::key_type>>::value) {
+        assert(&*dest.begin() == before);
+    }
+
+    // In place, with dest as either operand.
+    FS a2 = a;
+    op(a2, b, a2);
+    assert(Keys(a2.begin(), a2.end()) == expected);
+    FS b2 = b;
+    op(a, b2, b2);
+    assert(Keys(b2.begin(), b2.end()) == expected);
+
+    // With both operands the same set.
+    Keys self;
+    op.expected(a, a, std::back_inserter(self));
+    FS a3 = a;
+    op(a3, a3, a3);
+    assert(Keys(a3.begin(), a3.end()) == self);
+    FS d3 = b;
+    op(a, a, d3);
+    assert(Keys(d3.begin(), d3.end()) == self);
+}
+
+template<class FS, class Make>
+static void SetAlgebraTest(Make make)
+{
+    std::mt19937 g;
+    for (size_t na : {0, 1, 3, 7, 64, 1000}) {
+        for (size_t nb : {0, 2, 5, 64, 333}) {
+            FS a = random_set<FS>(g, na, make);
+            FS b = random_set<FS>(g, nb, make);
+            CheckSetOp(a, b, set_union_op());
+            CheckSetOp(a, b, set_intersection_op());
+            CheckSetOp(a, b, set_difference_op());
+            CheckSetOp(a, b, set_symmetric_difference_op());
+        }
+    }
+}
+
+template<class T>
+static T key_from(size_t i) { return static_cast<T>(i); }
+
+template<>
+std::string key_from<std::string>(size_t i) { return std::to_string(i); }
+
+#if defined(SG14_BENCHMARKS)
+static void SetAlgebraBenchmark()
+{
+    std::mt19937 g;
+    const size_t n = 1000000;
+    for (unsigned density : {2, 16}) {
+        std::vector<std::uint32_t> ka, kb;
+        for (size_t i = 0; i < n; ++i) {
+            ka.push_back(static_cast<std::uint32_t>(g() % (density * n)));
+            kb.push_back(static_cast<std::uint32_t>(g() % (density * n)));
+        }
+        stdext::flat_set<std::uint32_t> a(ka), b(kb), dest;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        std::vector<std::uint32_t> generic;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(generic));
+        stdext::flat_set<std::uint32_t> result(stdext::sorted_unique, std::move(generic));
+        auto t1 = std::chrono::high_resolution_clock::now();
+        stdext::set_intersection(a, b, dest);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        stdext::set_intersection(a, b, dest);
+        auto t3 = std::chrono::high_resolution_clock::now();
+        assert(result == dest);
+        printf("flat_set<uint32_t> intersection of %zu and %zu keys: std::set_intersection %lld, simd %lld, simd reusing dest %lld\n",
+            a.size(), b.size(), (long long)(t1 - t0).count(), (long long)(t2 - t1).count(), (long long)(t3 - t2).count());
+    }
+}
+#endif
+
 } // anonymous namespace
 
 void sg14_test::flat_set_test()
@@ -285,6 +578,22 @@ void sg14_test::flat_set_test()
     ThrowingSwapDoesntBreakInvariants();
     VectorBoolSanityTest();
     VectorBoolEvilComparatorTest();
+    HeterogeneousLookupTest();
+    BranchlessSearchTest<int, std::less<int>>();
+    BranchlessSearchTest<unsigned, std::less<unsigned>>();
+    BranchlessSearchTest<float, std::less<float>>();
+    BranchlessSearchTest<double, std::less<>>();
+    BranchlessSearchTest<short, std::less<short>>();
+    BranchlessSearchTest<unsigned char, std::less<unsigned char>>();
+    BranchlessSearchTest<long long, std::less<long long>>();
+    BranchlessSearchTest<std::uint64_t, std::less<std::uint64_t>>();
+    BranchlessSearchTest<int, PlainLess>();
+    SetAlgebraTest<stdext::flat_set<std::uint32_t>>(key_from<std::uint32_t>);
+    SetAlgebraTest<stdext::flat_set<std::int64_t>>(key_from<std::int64_t>);
+    SetAlgebraTest<stdext::flat_set<std::uint64_t, std::less<>>>(key_from<std::uint64_t>);
+    SetAlgebraTest<stdext::flat_set<int, std::greater<int>>>(key_from<int>);
+    SetAlgebraTest<stdext::flat_set<int, std::less<int>, std::deque<int>>>(key_from<int>);
+    SetAlgebraTest<stdext::flat_set<std::string>>(key_from<std::string>);
 
     // Test the most basic flat_set.
     {
@@ -324,6 +633,11 @@ void sg14_test::flat_set_test()
         SpecialMemberTest<FS>();
     }
 #endif
+
+#if defined(SG14_BENCHMARKS)
+    SearchBenchmark();
+    SetAlgebraBenchmark();
+#endif
 }
 
 #ifdef TEST_MAIN
@@ -0,0 +1,254 @@
+#include "SG14_test.h"
+#include "flat_map.h"
+#include "front_coded_strings.h"
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <random>
+#include <stdio.h>
+#include <string>
+#if __has_include(<string_view>)
+#include <string_view>
+#endif
+#include <vector>
+
+namespace {
+
+// Keys with long shared prefixes, equal 8-byte prefixes, embedded NULs,
+// bytes above 0x7f, and the empty string.
+static std::vector<std::string> make_keys(std::mt19937& g, size_t n)
+{
+    static const std::string stems[] = {"", "a", "ab", "abcdefgh", "abcdefghi", "/api/v1/users/", "/api/v1/orders/", "\xff\xfe", std::string("x\0y", 3)};
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+        std::string s = stems[g() % 9];
+        if (g() % 7 == 0) {
+            s.push_back('\0');
+        }
+        for (unsigned k = g() % 6; k != 0; --k) {
+            s.push_back(static_cast<char>("az\x80\x01/"[g() % 5]));
+        }
+        keys.push_back(s);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+template<size_t BlockSize>
+static void ContainerTest()
+{
+    using FC = stdext::front_coded_strings<BlockSize>;
+    std::mt19937 g;
+    std::vector<std::string> model = make_keys(g, 200);
+    FC fc(model.begin(), model.end());
+    assert(fc.size() == model.size());
+    assert(std::equal(fc.begin(), fc.end(), model.begin(), model.end()));
+    assert(std::equal(fc.rbegin(), fc.rend(), model.rbegin(), model.rend()));
+    assert(FC(fc) == fc);
+
+    // Edits anywhere, checked against a vector after each one.
+    for (int step = 0; step < 400; ++step) {
+        std::string s = make_keys(g, 1).front() + std::to_string(step);
+        size_t i = model.empty() ? 0 : g() % (model.size() + 1);
+        switch (g() % 6) {
+            case 0:
+                fc.insert(fc.begin() + static_cast<ptrdiff_t>(i), s);
+                model.insert(model.begin() + static_cast<ptrdiff_t>(i), s);
+                break;
+            case 1:
+                fc.push_back(s);
+                model.push_back(s);
+                break;
+            case 2:
+                if (i < model.size()) {
+                    fc.erase(fc.begin() + static_cast<ptrdiff_t>(i));
+                    model.erase(model.begin() + static_cast<ptrdiff_t>(i));
+                }
+                break;
+            case 3:
+                fc.erase(fc.begin() + static_cast<ptrdiff_t>(i), fc.end());
+                model.erase(model.begin() + static_cast<ptrdiff_t>(i), model.end());
+                break;
+            default:
+                if (i < model.size()) {
+                    fc[i] = s;
+                    model[i] = s;
+                }
+                break;
+        }
+        assert(fc.size() == model.size());
+        assert(std::equal(fc.begin(), fc.end(), model.begin(), model.end()));
+    }
+
+    // Mutable iterators yield proxies that standard algorithms can permute.
+    std::shuffle(model.begin(), model.end(), g);
+    fc = FC(model.begin(), model.end());
+    std::sort(fc.begin(), fc.end());
+    std::sort(model.begin(), model.end());
+    assert(std::equal(fc.begin(), fc.end(), model.begin(), model.end()));
+    std::reverse(fc.begin(), fc.end());
+    std::iter_swap(fc.begin(), fc.end() - 1);
+    std::reverse(model.begin(), model.end());
+    std::iter_swap(model.begin(), model.end() - 1);
+    assert(std::equal(fc.begin(), fc.end(), model.begin(), model.end()));
+
+    fc.clear();
+    assert(fc.empty() && fc.begin() == fc.end());
+}
+
+template<size_t BlockSize>
+static void BoundIndexTest()
+{
+    using FC = stdext::front_coded_strings<BlockSize>;
+    std::mt19937 g;
+    std::less<> transparent;
+    std::less<std::string> plain;
+    for (size_t n : {0, 1, 2, 15, 16, 17, 100, 1000}) {
+        std::vector<std::string> keys = make_keys(g, n);
+        FC fc(keys.begin(), keys.end());
+        std::vector<std::string> probes = make_keys(g, 300);
+        probes.insert(probes.end(), keys.begin(), keys.end());
+        for (const std::string& x : probes) {
+            size_t lo = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), x) - keys.begin());
+            size_t hi = static_cast<size_t>(std::upper_bound(keys.begin(), keys.end(), x) - keys.begin());
+            assert(fc.bound_index(x, plain, std::false_type()) == lo);
+            assert(fc.bound_index(x, plain, std::true_type()) == hi);
+            assert(fc.bound_index(x, transparent, std::false_type()) == lo);
+            assert(fc.bound_index(x, transparent, std::true_type()) == hi);
+#if defined(__cpp_lib_string_view)
+            assert(fc.bound_index(std::string_view(x), transparent, std::false_type()) == lo);
+#endif
+            if (x.find('\0') == std::string::npos) {
+                assert(fc.bound_index(x.c_str(), transparent, std::true_type()) == hi);
+            }
+        }
+    }
+}
+
+template<class P, class Q>
+static bool same_element(const P& p, const Q& q)
+{
+    return p.first == q.first && p.second == q.second;
+}
+
+template<class FM>
+static void FlatMapTest()
+{
+    std::mt19937 g;
+    FM fm;
+    std::map<std::string, int> model;
+    std::vector<std::string> keys = make_keys(g, 500);
+    std::shuffle(keys.begin(), keys.end(), g);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const std::string& k = keys[i];
+        switch (i % 4) {
+            case 0:
+                assert(fm.try_emplace(k, int(i)).second == model.emplace(k, int(i)).second);
+                break;
+            case 1:
+                fm.insert_or_assign(k, int(i));
+                model[k] = int(i);
+                break;
+            case 2:
+                fm.emplace(k, int(i));
+                model.emplace(k, int(i));
+                break;
+            default:
+                assert(fm.erase(keys[i / 2]) == model.erase(keys[i / 2]));
+                break;
+        }
+    }
+    assert(fm.size() == model.size());
+    assert(std::equal(fm.begin(), fm.end(), model.begin(), model.end(), same_element<typename FM::reference, std::pair<const std::string, int>>));
+
+    // Bulk insertion sorts and merges through the proxies.
+    std::vector<std::pair<std::string, int>> more;
+    for (const std::string& k : make_keys(g, 300)) {
+        more.emplace_back(k + "!", 7);
+    }
+    std::shuffle(more.begin(), more.end(), g);
+    fm.insert(more.begin(), more.end());
+    model.insert(more.begin(), more.end());
+    assert(std::equal(fm.begin(), fm.end(), model.begin(), model.end(), same_element<typename FM::reference, std::pair<const std::string, int>>));
+
+    const FM& cfm = fm;
+    for (const std::string& k : make_keys(g, 300)) {
+        auto it = model.lower_bound(k);
+        size_t lo = static_cast<size_t>(std::distance(model.begin(), it));
+        assert(static_cast<size_t>(cfm.lower_bound(k) - cfm.begin()) == lo);
+        assert(cfm.count(k) == model.count(k));
+        assert((cfm.find(k) == cfm.end()) == (model.find(k) == model.end()));
+        if (it != model.end()) {
+            assert(cfm.at(it->first) == it->second);
+        }
+    }
+    FM copy(stdext::sorted_unique, fm.keys(), fm.values());
+    assert(copy == fm);
+}
+
+#if defined(SG14_BENCHMARKS)
+static void LookupBenchmark()
+{
+    std::mt19937 g;
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 1000000; ++i) {
+        keys.push_back("/api/v1/users/" + std::to_string(g() % 100000000) + "/profile");
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::vector<std::string> probes;
+    for (size_t i = 0; i < 200000; ++i) {
+        probes.push_back(keys[g() % keys.size()]);
+    }
+
+    std::vector<int> values(keys.size(), 1);
+    stdext::flat_map<std::string, int, std::less<>> plain(stdext::sorted_unique, keys, values);
+    stdext::flat_map<std::string, int, std::less<>, stdext::front_coded_strings<>> coded(
+        stdext::sorted_unique, stdext::front_coded_strings<>(keys.begin(), keys.end()), values);
+
+    size_t plain_bytes = keys.capacity() * sizeof(std::string);
+    for (const std::string& k : keys) {
+        plain_bytes += (k.size() > 15) ? k.capacity() + 1 : 0;
+    }
+    size_t sum_plain = 0, sum_coded = 0;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (const std::string& k : probes) {
+        sum_plain += static_cast<size_t>(plain.lower_bound(k) - plain.begin());
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (const std::string& k : probes) {
+        sum_coded += static_cast<size_t>(coded.lower_bound(k) - coded.begin());
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    assert(sum_plain == sum_coded);
+    printf("%zu string keys: vector<string> %zu bytes, lower_bound %lld; front_coded_strings %zu bytes, lower_bound %lld\n",
+        keys.size(), plain_bytes, (long long)(t1 - t0).count(), coded.keys().memory_usage(), (long long)(t2 - t1).count());
+}
+#endif
+
+} // anonymous namespace
+
+void sg14_test::front_coded_strings_test()
+{
+    ContainerTest<1>();
+    ContainerTest<4>();
+    ContainerTest<16>();
+    BoundIndexTest<1>();
+    BoundIndexTest<3>();
+    BoundIndexTest<16>();
+    FlatMapTest<stdext::flat_map<std::string, int, std::less<std::string>, stdext::front_coded_strings<>>>();
+    FlatMapTest<stdext::flat_map<std::string, int, std::less<>, stdext::front_coded_strings<8>>>();
+#if defined(SG14_BENCHMARKS)
+    LookupBenchmark();
+#endif
+}
+
+#ifdef TEST_MAIN
+int main()
+{
+    sg14_test::front_coded_strings_test();
+}
+#endif
@@ -0,0 +1,127 @@
+#include "SG14_test.h"
+#include "frozen_flat_map.h"
+#include <assert.h>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+template<class FM>
+static void MirrorTest()
+{
+    // Check iteration and every search against a std::map.
+    using Compare = typename FM::key_compare;
+    std::mt19937 g;
+    for (int n : {0, 1, 2, 5, 16, 31, 100, 1000}) {
+        std::map<int, std::string, Compare> m;
+        while (m.size() < size_t(n)) {
+            int k = static_cast<int>(g() % 5000);
+            m.emplace(k, std::to_string(k));
+        }
+        FM fm(stdext::sorted_unique, m.begin(), m.end());
+        const FM& cfm = fm;
+        assert(fm.size() == m.size());
+        assert(std::equal(fm.begin(), fm.end(), m.begin(), m.end(), [](const auto& a, const auto& b) {
+            return a.first == b.first && a.second == b.second;
+        }));
+        auto rit = cfm.rbegin();
+        for (auto jt = m.rbegin(); jt != m.rend(); ++jt, ++rit) {
+            assert((*rit).first == jt->first);
+        }
+        assert(rit == cfm.rend());
+        for (int x = -1; x <= 5000; x += 7) {
+            auto lo = m.lower_bound(x);
+            auto it = fm.lower_bound(x);
+            assert((it == fm.end()) == (lo == m.end()));
+            assert(it == fm.end() || it->first == lo->first);
+            auto hi = m.upper_bound(x);
+            auto cit = cfm.upper_bound(x);
+            assert((cit == cfm.end()) == (hi == m.end()));
+            assert(cit == cfm.end() || cit->first == hi->first);
+            assert(fm.count(x) == m.count(x));
+            auto range = fm.equal_range(x);
+            assert(range.first == it && std::distance(range.first, range.second) == std::distance(lo, hi));
+        }
+    }
+}
+
+static void MappedValueTest()
+{
+    stdext::flat_map<int, std::string> fm{{3, "three"}, {1, "one"}, {2, "two"}, {5, "five"}};
+    stdext::frozen_flat_map<int, std::string> frozen(fm);
+    assert(frozen.at(5) == "five");
+    bool threw = false;
+    try { (void)frozen.at(4); } catch (const std::out_of_range&) { threw = true; }
+    assert(threw);
+
+    // Keys are frozen, but the mapped values can still be assigned.
+    frozen.find(2)->second = "deux";
+    frozen.at(3) = "trois";
+    for (auto&& kv : frozen) {
+        kv.second += "!";
+    }
+    stdext::frozen_flat_map<int, std::string>::const_iterator cit = frozen.find(1);
+    assert(cit->second == "one!");
+
+    auto thawed = std::move(frozen).thaw();
+    assert(thawed == (stdext::flat_map<int, std::string>{{1, "one!"}, {2, "deux!"}, {3, "trois!"}, {5, "five!"}}));
+
+    stdext::frozen_flat_map<int, std::string> moved(std::move(fm));
+    assert(moved.size() == 4 && moved.at(1) == "one");
+    stdext::frozen_flat_map<int, std::string> other(stdext::sorted_unique, {{1, "one"}, {2, "two"}, {3, "three"}, {5, "five"}});
+    assert(moved == other);
+    other.at(1) = "uno";
+    assert(moved != other);
+}
+
+// Orders strings as usual, and a char against the first character of a
+// string, so that one char is equivalent to a run of keys.
+struct FirstCharLess {
+    using is_transparent = void;
+    bool operator()(const std::string& a, const std::string& b) const { return a < b; }
+    bool operator()(const std::string& a, char b) const { return a[0] < b; }
+    bool operator()(char a, const std::string& b) const { return a < b[0]; }
+};
+
+static void HeterogeneousRangeTest()
+{
+    stdext::frozen_flat_map<std::string, int, FirstCharLess> fm(stdext::sorted_unique,
+        {{"apple", 1}, {"banana", 2}, {"blueberry", 3}, {"cherry", 4}, {"cranberry", 5}, {"currant", 6}, {"date", 7}});
+    const auto& cfm = fm;
+    assert(fm.count('b') == 2);
+    assert(fm.count('c') == 3);
+    assert(fm.count('z') == 0);
+    auto r = fm.equal_range('c');
+    assert(r.first->second == 4 && r.second->second == 7);
+    assert(std::distance(r.first, r.second) == 3);
+    auto cr = cfm.equal_range('b');
+    assert(cr.first->first == "banana" && cr.second->first == "cherry");
+    for (auto it = r.first; it != r.second; ++it) {
+        it->second = 0;
+    }
+    assert(fm.at("cranberry") == 0 && fm.at("date") == 7);
+}
+
+} // anonymous namespace
+
+void sg14_test::frozen_flat_map_test()
+{
+    MirrorTest<stdext::frozen_flat_map<int, std::string>>();
+    MirrorTest<stdext::frozen_flat_map<int, std::string, std::greater<int>>>();
+    MirrorTest<stdext::frozen_flat_map<int, std::string, std::less<>, std::deque<int>, std::deque<std::string>>>();
+    MappedValueTest();
+    HeterogeneousRangeTest();
+}
+
+#ifdef TEST_MAIN
+int main()
+{
+    sg14_test::frozen_flat_map_test();
+}
+#endif
@@ -0,0 +1,162 @@
+#include "SG14_test.h"
+#include "frozen_flat_set.h"
+#include <assert.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+template<class FS>
+static void SearchTest()
+{
+    // Compare every search against std::lower_bound over the sorted keys,
+    // for complete and incomplete trees alike.
+    using Compare = typename FS::key_compare;
+    for (int n = 0; n < 70; ++n) {
+        std::vector<int> sorted;
+        for (int i = 0; i < n; ++i) {
+            sorted.push_back(2 * i);
+        }
+        std::sort(sorted.begin(), sorted.end(), Compare());
+        FS fs(stdext::sorted_unique, sorted.begin(), sorted.end());
+        assert(fs.size() == sorted.size());
+        assert(std::equal(fs.begin(), fs.end(), sorted.begin(), sorted.end()));
+        assert(std::equal(fs.rbegin(), fs.rend(), sorted.rbegin(), sorted.rend()));
+        for (int x = -1; x <= 2 * n; ++x) {
+            auto lo = std::lower_bound(sorted.begin(), sorted.end(), x, Compare());
+            auto hi = std::upper_bound(sorted.begin(), sorted.end(), x, Compare());
+            auto it = fs.lower_bound(x);
+            assert((it == fs.end()) == (lo == sorted.end()));
+            assert(it == fs.end() || *it == *lo);
+            auto jt = fs.upper_bound(x);
+            assert((jt == fs.end()) == (hi == sorted.end()));
+            assert(jt == fs.end() || *jt == *hi);
+            auto range = fs.equal_range(x);
+            assert(range.first == it && range.second == jt);
+            assert(fs.contains(x) == (lo != hi));
+            assert(fs.count(x) == size_t(hi - lo));
+            assert((fs.find(x) == fs.end()) == (lo == hi));
+        }
+    }
+}
+
+static void LayoutTest()
+{
+    // The root of the implicit tree comes first, then each level in turn.
+    stdext::frozen_flat_set<int> fs(stdext::sorted_unique, {1, 2, 3, 4, 5, 6, 7});
+    std::vector<int> expected = {4, 2, 6, 1, 3, 5, 7};
+    assert(fs.keys() == expected);
+    auto it = fs.find(6);
+    assert(*--it == 5);
+    assert(*++it == 6);
+    assert(*++it == 7);
+    assert(++it == fs.end());
+    assert(*--it == 7);
+
+    stdext::frozen_flat_set<int> empty;
+    assert(empty.begin() == empty.end() && empty.find(1) == empty.end());
+}
+
+static void ConversionTest()
+{
+    stdext::flat_set<std::string> words{"delta", "alpha", "echo", "charlie", "bravo"};
+    stdext::frozen_flat_set<std::string> frozen(words);
+    assert(std::equal(frozen.begin(), frozen.end(), words.begin(), words.end()));
+    assert(frozen.contains("charlie") && !frozen.contains("foxtrot"));
+
+    stdext::frozen_flat_set<std::string> moved(std::move(words));
+    assert(moved == frozen);
+    auto thawed = std::move(frozen).thaw();
+    assert(thawed == stdext::flat_set<std::string>({"alpha", "bravo", "charlie", "delta", "echo"}));
+    assert(frozen.empty());
+
+    // A transparent comparator allows lookups without building a std::string.
+    stdext::frozen_flat_set<std::string, std::less<>> transparent(stdext::sorted_unique, {"a", "b", "c"});
+    assert(transparent.find("b") != transparent.end());
+    assert(transparent.count("d") == 0);
+}
+
+// Orders strings as usual, and a char against the first character of a
+// string, so that one char is equivalent to a run of keys.
+struct FirstCharLess {
+    using is_transparent = void;
+    bool operator()(const std::string& a, const std::string& b) const { return a < b; }
+    bool operator()(const std::string& a, char b) const { return a[0] < b; }
+    bool operator()(char a, const std::string& b) const { return a < b[0]; }
+};
+
+static void HeterogeneousRangeTest()
+{
+    stdext::frozen_flat_set<std::string, FirstCharLess> fs(stdext::sorted_unique,
+        {"apple", "banana", "blueberry", "cherry", "cranberry", "currant", "date"});
+    assert(fs.count('a') == 1);
+    assert(fs.count('b') == 2);
+    assert(fs.count('c') == 3);
+    assert(fs.count('e') == 0);
+    auto r = fs.equal_range('c');
+    assert(*r.first == "cherry" && *r.second == "date");
+    assert(std::distance(r.first, r.second) == 3);
+    r = fs.equal_range('e');
+    assert(r.first == r.second && r.first == fs.end());
+    assert(*fs.find('b') == "banana");
+}
+
+#if defined(SG14_BENCHMARKS)
+static void LookupBenchmark()
+{
+    std::mt19937 g;
+    std::vector<int> probes(1 << 18);
+    for (int n : {1 << 10, 1 << 16, 1 << 20, 10000000}) {
+        std::vector<int> keys(n);
+        for (int i = 0; i < n; ++i) {
+            keys[i] = 2 * i;
+        }
+        for (int& x : probes) {
+            x = static_cast<int>(g() % (2u * unsigned(n)));
+        }
+        stdext::flat_set<int> sorted(stdext::sorted_unique, keys);
+        stdext::frozen_flat_set<int> frozen(stdext::sorted_unique, keys);
+        int hits_sorted = 0, hits_frozen = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int x : probes) {
+            hits_sorted += sorted.contains(x);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (int x : probes) {
+            hits_frozen += frozen.contains(x);
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        assert(hits_sorted == hits_frozen);
+        printf("contains x%zu over %d keys: flat_set %lld, frozen_flat_set %lld\n", probes.size(), n,
+            (long long)(t1 - t0).count(), (long long)(t2 - t1).count());
+    }
+}
+#endif
+
+} // anonymous namespace
+
+void sg14_test::frozen_flat_set_test()
+{
+    SearchTest<stdext::frozen_flat_set<int>>();
+    SearchTest<stdext::frozen_flat_set<int, std::greater<int>>>();
+    SearchTest<stdext::frozen_flat_set<int, std::less<>, std::deque<int>>>();
+    LayoutTest();
+    ConversionTest();
+    HeterogeneousRangeTest();
+#if defined(SG14_BENCHMARKS)
+    LookupBenchmark();
+#endif
+}
+
+#ifdef TEST_MAIN
+int main()
+{
+    sg14_test::frozen_flat_set_test();
+}
+#endif
@@ -8,12 +8,19 @@
 
 int main(int, char *[])
 {
+    sg14_test::buffered_flat_map_test();
+    sg14_test::concurrent_slot_map_test();
+    sg14_test::double_mapped_ring_test();
     sg14_test::flat_map_test();
     sg14_test::flat_set_test();
+    sg14_test::front_coded_strings_test();
+    sg14_test::frozen_flat_map_test();
+    sg14_test::frozen_flat_set_test();
     sg14_test::inplace_function_test();
     sg14_test::plf_colony_test();
     sg14_test::ring_test();
     sg14_test::slot_map_test();
+    sg14_test::soa_slot_map_test();
     sg14_test::uninitialized_test();
     sg14_test::unstable_remove_test();
 
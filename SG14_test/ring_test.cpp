@@ -1,10 +1,20 @@
 #include "SG14_test.h"
 
 #include "ring.h"
+#include "inplace_function.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
 #include <numeric>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 static void basic_test()
@@ -165,6 +175,398 @@ static void reverse_iterator_test()
     static_assert(std::is_same<decltype(c.crend()), decltype(r)::const_reverse_iterator>::value, "");
 }
 
+static void spsc_basic_test()
+{
+    std::array<int, 4> A;
+    sg14::spsc_ring_span<int> r(A.begin(), A.end());
+    assert(r.empty());
+    assert(r.capacity() == 4);
+
+    int out = 0;
+    assert(!r.try_pop_front(out));
+    assert(r.try_push_back(1));
+    assert(r.try_push_back(2));
+    assert(r.try_emplace_back(3));
+    assert(r.try_push_back(4));
+    assert(r.full());
+    assert(!r.try_push_back(5));  // a full ring rejects rather than overwrites
+    assert(r.size() == 4);
+
+    assert(r.try_pop_front(out) && out == 1);
+    assert(r.try_push_back(5));
+    assert(r.try_pop_front(out) && out == 2);
+    assert(r.try_pop_front(out) && out == 3);
+    assert(r.try_pop_front(out) && out == 4);
+    assert(r.try_pop_front(out) && out == 5);
+    assert(!r.try_pop_front(out));
+    assert(r.empty());
+}
+
+static void spsc_threaded_test()
+{
+    const int total = 100000;
+    std::vector<std::string> storage(8);
+    sg14::spsc_ring_span<std::string> r(storage.begin(), storage.end());
+
+    std::thread producer([&]() {
+        for (int i = 0; i < total; ++i) {
+            std::string s = std::to_string(i);
+            while (!r.try_push_back(std::move(s))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::string out;
+    for (int i = 0; i < total; ++i) {
+        while (!r.try_pop_front(out)) {
+            std::this_thread::yield();
+        }
+        assert(out == std::to_string(i));
+    }
+    producer.join();
+    assert(r.empty());
+}
+
+static void bulk_test()
+{
+    std::array<int, 5> A;
+    sg14::ring_span<int> r(A.begin(), A.end());
+
+    std::vector<int> in {1, 2, 3};
+    r.push_back(in.begin(), in.end());
+    assert(r.size() == 3);
+    assert(r.front() == 1 && r.back() == 3);
+
+    std::vector<int> out;
+    r.pop_front_n(std::back_inserter(out), 2);
+    assert((out == std::vector<int>{1, 2}));
+    assert(r.size() == 1);
+
+    // Wraps around the end of the storage and overwrites the oldest element.
+    in = {4, 5, 6, 7, 8};
+    r.push_back(in.begin(), in.end());
+    assert(r.full());
+    assert((std::vector<int>(r.begin(), r.end()) == std::vector<int>{4, 5, 6, 7, 8}));
+
+    // More elements than capacity: only the last capacity() survive.
+    in = {10, 11, 12, 13, 14, 15, 16};
+    r.push_back(in.begin(), in.end());
+    assert((std::vector<int>(r.begin(), r.end()) == std::vector<int>{12, 13, 14, 15, 16}));
+
+    // Input iterators take the element-wise path.
+    std::istringstream iss("20 21");
+    r.push_back(std::istream_iterator<int>(iss), std::istream_iterator<int>());
+    assert((std::vector<int>(r.begin(), r.end()) == std::vector<int>{14, 15, 16, 20, 21}));
+}
+
+static void segment_test()
+{
+    std::array<char, 8> A;
+    sg14::ring_span<char> r(A.begin(), A.end());
+
+    auto w = r.writable_segments();
+    assert(w.first.size() == 8 && w.second.empty());
+    std::memcpy(w.first.data(), "abcdef", 6);
+    r.commit_back(6);
+    assert(r.size() == 6 && r.front() == 'a' && r.back() == 'f');
+
+    char buf[8];
+    auto rd = r.readable_segments();
+    assert(rd.first.size() == 6 && rd.second.empty());
+    std::memcpy(buf, rd.first.data(), 4);
+    r.drop_front(4);
+    assert(std::string(buf, 4) == "abcd");
+    assert(r.size() == 2 && r.front() == 'e');
+
+    // The free space now wraps: 2 slots at the end, 4 at the start.
+    w = r.writable_segments();
+    assert(w.first.data() == &A[6] && w.first.size() == 2);
+    assert(w.second.data() == &A[0] && w.second.size() == 4);
+    std::memcpy(w.first.data(), "gh", 2);
+    std::memcpy(w.second.data(), "ijk", 3);
+    r.commit_back(5);
+    assert(std::string(r.begin(), r.end()) == "efghijk");
+
+    const auto& cr = r;
+    auto crd = cr.readable_segments();
+    static_assert(std::is_same<decltype(crd.first.data()), const char*>::value, "");
+    assert(std::string(crd.first.begin(), crd.first.end()) == "efgh");
+    assert(std::string(crd.second.begin(), crd.second.end()) == "ijk");
+}
+
+namespace {
+struct Counted {
+    static int live;
+    explicit Counted(int v) : value(v) { ++live; }
+    Counted(const Counted& rhs) : value(rhs.value) { ++live; }
+    Counted(Counted&& rhs) noexcept : value(rhs.value) { ++live; }
+    Counted& operator=(const Counted&) = default;
+    ~Counted() { --live; }
+    int value;
+};
+int Counted::live = 0;
+} // namespace
+
+static void static_ring_test()
+{
+    static_assert(sg14::static_ring<Counted, 3>::capacity() == 3, "");
+    {
+        sg14::static_ring<Counted, 3> r;
+        assert(r.empty());
+        assert(Counted::live == 0);  // no default construction up front
+
+        r.emplace_back(1);
+        r.push_back(Counted(2));
+        r.emplace_back(3);
+        assert(r.full());
+        assert(Counted::live == 3);
+
+        r.emplace_back(4);  // evicts 1
+        assert(Counted::live == 3);
+        assert(r.front().value == 2 && r.back().value == 4);
+
+        Counted c = r.pop_front();
+        assert(c.value == 2);
+        assert(r.size() == 2);
+
+        r.emplace_back(r.front());  // argument aliases an element
+        sg14::static_ring<Counted, 3> r2 = r;
+        assert(r2.size() == 3);
+        std::vector<int> v;
+        for (auto&& e : r2) {
+            v.push_back(e.value);
+        }
+        assert((v == std::vector<int>{3, 4, 3}));
+
+        r2.emplace_back(5);  // full, argument is not an element
+        assert(r2.front().value == 4 && r2.back().value == 5);
+        r = std::move(r2);
+        assert(r.size() == 3 && r.back().value == 5);
+        r.clear();
+        assert(r.empty());
+    }
+    assert(Counted::live == 0);
+}
+
+static void dynamic_ring_test()
+{
+    {
+        sg14::dynamic_ring<Counted> r;
+        assert(r.empty() && r.capacity() == 0);
+
+        for (int i = 0; i < 4; ++i) {
+            r.emplace_back(i);
+        }
+        assert(r.capacity() == 4);
+        r.pop_front();
+        r.pop_front();
+        r.emplace_back(4);
+        r.emplace_back(5);  // now wrapped: storage holds 4 5 2 3
+        assert(r.capacity() == 4);
+        r.emplace_back(r.front());  // grows, linearizing; argument aliases the old buffer
+        assert(r.capacity() == 8);
+        assert(Counted::live == 5);
+
+        std::vector<int> v;
+        for (auto&& e : r) {
+            v.push_back(e.value);
+        }
+        assert((v == std::vector<int>{2, 3, 4, 5, 2}));
+
+        sg14::dynamic_ring<Counted> r2(r);
+        assert(r2.size() == 5 && r2.front().value == 2 && r2.back().value == 2);
+        sg14::dynamic_ring<Counted> r3(std::move(r2));
+        assert(r2.empty() && r3.size() == 5);
+        r = r3;
+        assert(r.size() == 5);
+        swap(r, r3);
+        r3 = std::move(r);
+        assert(r3.size() == 5);
+
+        r3.reserve(100);
+        assert(r3.capacity() == 128);
+        assert(r3.front().value == 2);
+    }
+    assert(Counted::live == 0);
+
+    sg14::dynamic_ring<std::unique_ptr<int>> mr;
+    for (int i = 0; i < 10; ++i) {
+        mr.push_back(std::make_unique<int>(i));
+    }
+    assert(*mr.pop_front() == 0);
+    assert(*mr.back() == 9);
+}
+
+static void pow2_test()
+{
+    std::array<int, 4> A;
+    sg14::pow2_ring_span<int> r(A.begin(), A.end());
+    assert(r.empty());
+    assert(r.capacity() == 4);
+
+    r.push_back(1);
+    r.push_back(2);
+    r.emplace_back(3);
+    assert(r.size() == 3);
+    assert(r.front() == 1);
+    assert(r.back() == 3);
+    assert(r.pop_front() == 1);
+
+    r.push_back(4);
+    r.push_back(5);
+    assert(r.full());
+    r.push_back(6);  // overwrites the oldest element, like ring_span
+    assert(r.full());
+    assert(r.front() == 3);
+    assert(r.back() == 6);
+
+    std::vector<int> v(4);
+    std::copy(r.begin(), r.end(), v.begin());
+    assert((v == std::vector<int>{3,4,5,6}));
+    std::copy(r.crbegin(), r.crend(), v.begin());
+    assert((v == std::vector<int>{6,5,4,3}));
+    assert(r.end() - r.begin() == 4);
+
+    // Start in the middle of the storage, wrapping around its end.
+    sg14::pow2_ring_span<int> r2(A.begin(), A.end(), A.begin() + 2, 4);
+    assert(r2.size() == 4);
+    assert(r2.front() == A[2]);
+    assert(r2.back() == A[1]);
+
+    swap(r, r2);
+    assert(r.front() == A[2]);
+    while (!r.empty()) {
+        r.pop_front();
+    }
+    assert(r.size() == 0);
+}
+
+#if defined(SG14_BENCHMARKS)
+template<class Ring>
+static auto ring_throughput(int runs)
+{
+    // Hide the capacity from the optimizer, or it folds the modulo away.
+    volatile std::size_t capacity = 1024;
+    std::vector<int> storage(capacity);
+    std::vector<long long> times;
+    long long sum = 0;
+    for (int run = 0; run < runs; ++run) {
+        Ring r(storage.begin(), storage.end());
+        for (int i = 0; i < 100; ++i) {
+            r.push_back(i);
+        }
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 100000; ++i) {
+            r.push_back(i);
+            sum += r.pop_front();
+            sum += r.back();
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        times.push_back((t1 - t0).count());
+    }
+    assert(sum > 0);
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static void pow2_benchmark_test()
+{
+    std::cout << "ring_span: " << ring_throughput<sg14::ring_span<int>>(21) << "\n";
+    std::cout << "pow2_ring_span: " << ring_throughput<sg14::pow2_ring_span<int>>(21) << "\n";
+}
+#endif
+
+static void mpmc_basic_test()
+{
+    std::array<sg14::mpmc_ring_span<int>::cell_type, 4> A;
+    sg14::mpmc_ring_span<int> r(A.begin(), A.end());
+    assert(r.empty());
+    assert(r.capacity() == 4);
+
+    int out = 0;
+    assert(!r.try_pop_front(out));
+    assert(r.try_push_back(1));
+    assert(r.try_push_back(2));
+    assert(r.try_emplace_back(3));
+    assert(r.try_push_back(4));
+    assert(!r.try_push_back(5));
+    assert(r.size() == 4);
+
+    assert(r.try_pop_front(out) && out == 1);
+    assert(r.try_push_back(5));
+    assert(r.try_pop_front(out) && out == 2);
+    assert(r.try_pop_front(out) && out == 3);
+    assert(r.try_pop_front(out) && out == 4);
+    assert(r.try_pop_front(out) && out == 5);
+    assert(!r.try_pop_front(out));
+    assert(r.empty());
+}
+
+// Runs `producers` threads pushing `per_producer` jobs each against
+// `consumers` threads that run them, and returns the elapsed time.
+static auto mpmc_run(int producers, int consumers, int per_producer)
+{
+    using job = stdext::inplace_function<void()>;
+    std::vector<sg14::mpmc_ring_span<job>::cell_type> storage(64);
+    sg14::mpmc_ring_span<job> r(storage.begin(), storage.end());
+
+    const int total = producers * per_producer;
+    std::atomic<int> consumed{0};
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> threads;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < per_producer; ++i) {
+                int value = p * per_producer + i;
+                while (!r.try_emplace_back([&sum, value]() { sum += value; })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            job j;
+            while (consumed.load() < total) {
+                if (r.try_pop_front(j)) {
+                    j();
+                    ++consumed;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto&& t : threads) {
+        t.join();
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    assert(r.empty());
+    assert(sum == (long long)total * (total - 1) / 2);
+    return (t1 - t0).count();
+}
+
+static void mpmc_contention_test()
+{
+    (void)mpmc_run(2, 2, 5000);
+}
+
+#if defined(SG14_BENCHMARKS)
+static void mpmc_contention_benchmark()
+{
+    for (int producers : {1, 2, 4}) {
+        for (int consumers : {1, 2, 4}) {
+            auto elapsed = mpmc_run(producers, consumers, 20000 / producers);
+            std::cout << "mpmc " << producers << "p/" << consumers << "c: " << elapsed << "\n";
+        }
+    }
+}
+#endif
+
 void sg14_test::ring_test()
 {
     basic_test();
@@ -172,6 +574,19 @@ void sg14_test::ring_test()
     iterator_regression_test();
     copy_popper_test();
     reverse_iterator_test();
+    bulk_test();
+    segment_test();
+    static_ring_test();
+    dynamic_ring_test();
+    pow2_test();
+    spsc_basic_test();
+    spsc_threaded_test();
+    mpmc_basic_test();
+    mpmc_contention_test();
+#if defined(SG14_BENCHMARKS)
+    pow2_benchmark_test();
+    mpmc_contention_benchmark();
+#endif
 }
 
 #ifdef TEST_MAIN
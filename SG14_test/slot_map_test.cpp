@@ -3,15 +3,28 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <deque>
 #include <forward_list>
 #include <list>
 #include <iterator>
 #include <memory>
+#include <numeric>
 #include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <utility>
 
+#if defined(__unix__)
+#include <sys/mman.h>
+#endif
+
 namespace TestKey {
 struct key_16_8_t {
     uint16_t index;
@@ -460,16 +473,9 @@ static void GenerationsDontSkipTest()
     sm.erase(k1);
     auto k2 = sm.emplace(Monad<T>::from_value(2));
 
-#if __cplusplus < 201703L
-    using std::get;
-    assert(get<0>(k2) == get<0>(k1));
-    assert(get<1>(k2) == get<1>(k1) + 1);
-#else
-    auto [idx1, gen1] = k1;
-    auto [idx2, gen2] = k2;
-    assert(idx2 == idx1);
-    assert(gen2 == gen1 + 1);
-#endif
+    using Traits = stdext::slot_map_key_traits<typename SM::key_type>;
+    assert(Traits::get_index(k2) == Traits::get_index(k1));
+    assert(Traits::get_generation(k2) == Traits::get_generation(k1) + 1);
 }
 
 template<class SM>
@@ -498,16 +504,821 @@ static void IndexesAreUsedEvenlyTest()
     k2 = sm.emplace(Monad<T>::from_value(2));
     sm.erase(k2);
 
-#if __cplusplus < 201703L
-    using std::get;
-    assert(get<0>(k2) != get<0>(k1));
-#else
-    auto [idx1, gen1] = k1;
-    auto [idx2, gen2] = k2;
-    assert(idx2 != idx1);
+    using Traits = stdext::slot_map_key_traits<typename SM::key_type>;
+    assert(Traits::get_index(k2) != Traits::get_index(k1));
+}
+
+template<class SM>
+static void FindBatchTest(int count = 100)
+{
+    using T = typename SM::mapped_type;
+    SM sm;
+    std::vector<typename SM::key_type> keys;
+    for (int i = 0; i < count; ++i) {
+        keys.push_back(sm.emplace(Monad<T>::from_value(i)));
+    }
+    for (int i = 0; i < count; i += 3) {
+        sm.erase(keys[i]);  // these keys are now expired
+    }
+    SM bigger;
+    typename SM::key_type out_of_range{};
+    for (int i = 0; i < count + 20; ++i) {
+        out_of_range = bigger.emplace(Monad<T>::from_value(i));
+    }
+    keys.push_back(out_of_range);  // its index is beyond sm's slots
+    std::mt19937 g;
+    std::shuffle(keys.begin(), keys.end(), g);
+
+    std::vector<typename SM::iterator> found;
+    sm.find_batch(keys.begin(), keys.end(), std::back_inserter(found));
+    assert(found.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        assert(found[i] == sm.find(keys[i]));
+    }
+
+    const SM& csm = sm;
+    std::vector<typename SM::const_iterator> cfound(keys.size());
+    auto end = csm.find_batch(keys.begin(), keys.end(), cfound.begin());
+    assert(end == cfound.end());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        assert(cfound[i] == csm.find(keys[i]));
+    }
+}
+
+template<class SM>
+static void StableAddressTest()
+{
+    using T = typename SM::mapped_type;
+    SM sm;
+    std::vector<typename SM::key_type> keys;
+    std::vector<const void*> addresses;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back(sm.emplace(Monad<T>::from_value(i)));
+        addresses.push_back(&sm[keys.back()]);
+    }
+    for (int i = 0; i < 100000; ++i) {
+        sm.emplace(Monad<T>::from_value(i));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        assert(&sm[keys[i]] == addresses[i]);
+        assert(Monad<T>::value_of(sm[keys[i]]) == i);
+    }
+}
+
+static void ChunkedVectorTest()
+{
+    using CV = stdext::chunked_vector<int>;
+    static_assert(CV::chunk_size == 1024, "");
+    static_assert(stdext::chunked_vector<char[5000]>::chunk_size == 16, "");
+    static_assert(std::is_nothrow_move_constructible<CV>::value, "");
+    CV v;
+    assert(v.segment_count() == 0);
+    for (int i = 0; i < 3000; ++i) {
+        v.emplace_back(i);
+    }
+    assert(v.size() == 3000 && v.capacity() == 3072);
+    assert(v.segment_count() == 3);
+    assert(v.segment_size(0) == 1024 && v.segment_size(2) == 3000 - 2048);
+    int expected = 0;
+    for (size_t s = 0; s < v.segment_count(); ++s) {
+        for (const int *p = v.segment_begin(s); p != v.segment_end(s); ++p) {
+            assert(*p == expected++);
+        }
+    }
+    assert(expected == 3000);
+    assert(v.end() - v.begin() == 3000);
+    assert(v.begin()[2500] == 2500 && *(v.rbegin()) == 2999);
+    CV::const_iterator cit = v.begin() + 1024;
+    assert(*cit == 1024 && cit > v.cbegin());
+
+    CV w = v;
+    v.pop_back();
+    v.shrink_to_fit();
+    assert(v.capacity() == 3072 && w.size() == 3000);
+
+    // A copy that throws part way frees every element and chunk it built,
+    // and copy-assignment leaves the target unchanged.
+    struct Fragile {
+        static int& live() { static int n = 0; return n; }
+        static int& copies_left() { static int n = -1; return n; }
+        explicit Fragile(int v) : value(v) { ++live(); }
+        Fragile(const Fragile& rhs) : value(rhs.value) {
+            if (copies_left()-- == 0) throw std::runtime_error("Fragile");
+            ++live();
+        }
+        ~Fragile() { --live(); }
+        int value;
+    };
+    using FV = stdext::chunked_vector<Fragile>;
+    {
+        FV f;
+        for (int i = 0; i < 3 * (int)FV::chunk_size; ++i) {
+            f.emplace_back(i);
+        }
+        FV g;
+        g.emplace_back(-1);
+        const int before = Fragile::live();
+        Fragile::copies_left() = 2 * FV::chunk_size + 5;
+        bool threw = false;
+        try { FV copy(f); } catch (const std::runtime_error&) { threw = true; }
+        assert(threw && Fragile::live() == before);
+        Fragile::copies_left() = FV::chunk_size + 5;
+        threw = false;
+        try { g = f; } catch (const std::runtime_error&) { threw = true; }
+        assert(threw && Fragile::live() == before);
+        assert(g.size() == 1 && g[0].value == -1);
+        Fragile::copies_left() = -1;
+        g = f;
+        assert(g.size() == f.size() && g.back().value == f.back().value);
+    }
+    assert(Fragile::live() == 0);
+}
+
+template<class SM>
+static void ParallelTest(int count = 10000)
+{
+    SM sm;
+    std::vector<typename SM::key_type> keys;
+    for (int i = 0; i < count; ++i) {
+        keys.push_back(sm.emplace(i));
+    }
+    for (int i = 0; i < count; i += 7) {
+        sm.erase(keys[i]);
+    }
+    for (unsigned threads : { 1u, 4u, 0u }) {
+        for (typename SM::size_type grain : { 0, 1, 100 }) {
+            sm.parallel_for_each([count](int& v) { v += count; }, grain, threads);
+            std::atomic<long long> chunk_total{0};
+            sm.parallel_for_each_chunk([&](auto first, auto last) {
+                long long sum = 0;
+                for (; first != last; ++first) {
+                    sum += *first;
+                    *first -= count;
+                }
+                chunk_total += sum;
+            }, grain, threads);
+            long long expected_total = 0;
+            for (int i = 0; i < count; ++i) {
+                if (i % 7 != 0) {
+                    assert(sm[keys[i]] == i);
+                    expected_total += i + count;
+                }
+            }
+            assert(chunk_total == expected_total);
+
+            std::vector<long long> out(sm.size());
+            sm.parallel_transform(out.begin(), [](int v) { return 2LL * v; }, grain, threads);
+            auto it = sm.begin();
+            for (long long x : out) {
+                assert(x == 2LL * *it);
+                ++it;
+            }
+        }
+    }
+    SM empty;
+    empty.parallel_for_each([](int&) { assert(false); });
+}
+
+static void ParallelRunsTest()
+{
+    // Contiguous containers hand out raw pointers, never crossing a chunk.
+    stdext::slot_map<int> vsm;
+    vsm.emplace(1);
+    vsm.parallel_for_each_chunk([](auto first, auto) {
+        static_assert(std::is_same<decltype(first), int*>::value, "");
+    });
+    using CV = stdext::chunked_vector<int>;
+    stdext::stable_slot_map<int> csm;
+    for (int i = 0; i < 5000; ++i) {
+        csm.emplace(i);
+    }
+    std::atomic<int> runs{0};
+    csm.parallel_for_each_chunk([&](auto first, auto last) {
+        static_assert(std::is_same<decltype(first), int*>::value, "");
+        assert(last - first <= static_cast<std::ptrdiff_t>(CV::chunk_size));
+        assert(*first / CV::chunk_size == *(last - 1) / CV::chunk_size);
+        ++runs;
+    }, 1500, 3);
+    assert(runs == 8);  // four chunks of up to 1500 values, split at 1024, 2048, 3072 and 4096
+}
+
+template<class SM>
+static void ReorderTest()
+{
+    using T = typename SM::mapped_type;
+    SM sm;
+    std::vector<std::pair<typename SM::key_type, int>> entries;
+    std::mt19937 g;
+    for (int i = 0; i < 1000; ++i) {
+        int v = static_cast<int>(g() % 500);
+        entries.emplace_back(sm.emplace(Monad<T>::from_value(v)), v);
+    }
+    for (int i = 0; i < 1000; i += 3) {
+        sm.erase(entries[i].first);
+    }
+    sm.reorder([](const T& a, const T& b) { return Monad<T>::value_of(a) > Monad<T>::value_of(b); });
+    assert(std::is_sorted(sm.begin(), sm.end(), [](const T& a, const T& b) { return Monad<T>::value_of(a) > Monad<T>::value_of(b); }));
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 3 == 0) {
+            assert(sm.find(entries[i].first) == sm.end());
+        } else {
+            assert(static_cast<int>(Monad<T>::value_of(sm.at(entries[i].first))) == entries[i].second);
+        }
+    }
+
+    // Erasing and inserting still work on the reordered map.
+    for (int i = 1; i < 1000; i += 3) {
+        sm.erase(entries[i].first);
+    }
+    auto k = sm.emplace(Monad<T>::from_value(-1));
+    assert(static_cast<int>(Monad<T>::value_of(sm[k])) == -1);
+    for (int i = 2; i < 1000; i += 3) {
+        assert(static_cast<int>(Monad<T>::value_of(sm.at(entries[i].first))) == entries[i].second);
+    }
+
+    SM empty;
+    empty.reorder([](const T&, const T&) { return false; });
+    assert(empty.empty());
+}
+
+static void SortValuesTest()
+{
+    stdext::slot_map<std::string> sm;
+    auto kc = sm.emplace("charlie");
+    auto ka = sm.emplace("alpha");
+    auto kb = sm.emplace("bravo");
+    sm.sort_values();
+    assert(std::is_sorted(sm.begin(), sm.end()));
+    assert(sm[ka] == "alpha" && sm[kb] == "bravo" && sm[kc] == "charlie");
+    assert(&*sm.begin() == &sm[ka]);
+}
+
+template<class SM>
+static void BulkInsertEraseTest()
+{
+    using T = typename SM::mapped_type;
+    using K = typename SM::key_type;
+    SM sm;
+    std::vector<K> singles;
+    for (int i = 0; i < 50; ++i) {
+        singles.push_back(sm.emplace(Monad<T>::from_value(i)));
+    }
+    for (int i = 0; i < 50; i += 2) {
+        sm.erase(singles[i]);  // leave some slots on the free list
+    }
+
+    std::vector<T> src;
+    for (int i = 0; i < 200; ++i) {
+        src.push_back(Monad<T>::from_value(1000 + i));
+    }
+    std::vector<K> keys(200);
+    auto out = sm.emplace_range(std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()), keys.begin());
+    assert(out == keys.end());
+    assert(sm.size() == 225);
+    for (int i = 0; i < 200; ++i) {
+        assert(static_cast<int>(Monad<T>::value_of(sm.at(keys[i]))) == 1000 + i);
+    }
+    for (int i = 1; i < 50; i += 2) {
+        assert(static_cast<int>(Monad<T>::value_of(sm.at(singles[i]))) == i);
+    }
+    std::vector<K> none;
+    sm.emplace_range(std::make_move_iterator(src.end()), std::make_move_iterator(src.end()), std::back_inserter(none));
+    assert(none.empty() && sm.size() == 225);
+
+    // Erase every third new key, some twice, plus expired keys, in shuffled order.
+    std::vector<K> doomed;
+    for (int i = 0; i < 200; i += 3) {
+        doomed.push_back(keys[i]);
+    }
+    doomed.push_back(keys[0]);
+    doomed.push_back(singles[0]);
+    doomed.push_back(singles[2]);
+    std::mt19937 g;
+    std::shuffle(doomed.begin(), doomed.end(), g);
+    assert(sm.erase_keys(doomed.begin(), doomed.end()) == 67);
+    assert(sm.erase_keys(doomed.begin(), doomed.end()) == 0);
+    assert(sm.size() == 225 - 67);
+    for (int i = 0; i < 200; ++i) {
+        if (i % 3 == 0) {
+            assert(sm.find(keys[i]) == sm.end());
+        } else {
+            assert(static_cast<int>(Monad<T>::value_of(sm.at(keys[i]))) == 1000 + i);
+        }
+    }
+
+    // The freed slots are reused by the next bulk insert.
+    auto slots_before = sm.slot_count();
+    std::vector<T> more;
+    for (int i = 0; i < 67; ++i) {
+        more.push_back(Monad<T>::from_value(i));
+    }
+    std::vector<K> more_keys;
+    sm.emplace_range(std::make_move_iterator(more.begin()), std::make_move_iterator(more.end()), std::back_inserter(more_keys));
+    assert(sm.slot_count() == slots_before);
+    for (int i = 0; i < 67; ++i) {
+        assert(static_cast<int>(Monad<T>::value_of(sm.at(more_keys[i]))) == i);
+    }
+}
+
+static void BulkInsertTest()
+{
+    // insert_n, and emplace_range from input iterators of unknown length.
+    stdext::slot_map<std::string> sm;
+    std::vector<stdext::slot_map<std::string>::key_type> keys;
+    sm.insert_n(3, "abc", std::back_inserter(keys));
+    assert(keys.size() == 3 && sm.size() == 3);
+    assert(sm[keys[0]] == "abc" && sm[keys[2]] == "abc" && keys[0] != keys[2]);
+
+    std::istringstream words("red green blue");
+    sm.emplace_range(std::istream_iterator<std::string>(words), std::istream_iterator<std::string>(), std::back_inserter(keys));
+    assert(keys.size() == 6 && sm[keys[4]] == "green");
+
+    // A value that fails to construct rolls back the whole call.
+    struct Picky {
+        Picky(int i) : value(i) { if (i == 13) throw std::runtime_error("unlucky"); }
+        int value;
+    };
+    stdext::slot_map<Picky> psm;
+    psm.emplace(1);
+    auto slots_before = psm.slot_count();
+    int values[] = { 10, 11, 12, 13, 14 };
+    std::vector<stdext::slot_map<Picky>::key_type> pkeys;
+    bool threw = false;
+    try {
+        psm.emplace_range(std::begin(values), std::end(values), std::back_inserter(pkeys));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && pkeys.empty());
+    assert(psm.size() == 1 && psm.begin()->value == 1);
+    psm.emplace_range(std::begin(values), std::begin(values) + 3, std::back_inserter(pkeys));
+    assert(psm.size() == 4 && psm.at(pkeys[2]).value == 12);
+    assert(psm.slot_count() >= slots_before);
+
+    // An output iterator that throws leaves the map consistent, whether
+    // the new slots come from the free list or are appended.
+    struct ThrowingOut {
+        std::vector<stdext::slot_map<int>::key_type> *keys;
+        ThrowingOut& operator*() { return *this; }
+        ThrowingOut& operator++() { return *this; }
+        ThrowingOut& operator=(const stdext::slot_map<int>::key_type& k) {
+            if (keys->size() == 1) throw std::runtime_error("full");
+            keys->push_back(k);
+            return *this;
+        }
+    };
+    for (int erased : { 0, 2 }) {
+        stdext::slot_map<int> sm2;
+        std::vector<stdext::slot_map<int>::key_type> old_keys;
+        sm2.insert_n(2, 1, std::back_inserter(old_keys));
+        for (int i = 0; i < erased; ++i) {
+            sm2.erase(old_keys[i]);
+        }
+        std::vector<stdext::slot_map<int>::key_type> delivered;
+        threw = false;
+        try {
+            sm2.insert_n(3, 7, ThrowingOut{&delivered});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && delivered.size() == 1 && sm2.at(delivered[0]) == 7);
+        auto k42 = sm2.insert(42);
+        assert(sm2.at(k42) == 42 && sm2.at(delivered[0]) == 7);
+        // load_snapshot checks the slots, reverse map and free list.
+        std::vector<char> buffer;
+        sm2.write_snapshot([&](const void *p, size_t n) { buffer.insert(buffer.end(), (const char*)p, (const char*)p + n); });
+        stdext::slot_map<int> copy;
+        copy.load_snapshot(buffer.data(), buffer.size());
+        assert(copy.size() == sm2.size() && copy.at(k42) == 42);
+        for (int i = 0; i < 10; ++i) {
+            auto k = sm2.insert(i);
+            assert(sm2.at(k) == i && sm2.at(delivered[0]) == 7 && sm2.at(k42) == 42);
+        }
+    }
+
+    // A few keys in a big map are ordered by sorting rather than by bitmap.
+    stdext::slot_map<int> big;
+    std::vector<int> src(5000);
+    std::iota(src.begin(), src.end(), 0);
+    std::vector<stdext::slot_map<int>::key_type> big_keys;
+    big.emplace_range(src.begin(), src.end(), std::back_inserter(big_keys));
+    stdext::slot_map<int>::key_type few[] = { big_keys[10], big_keys[4999], big_keys[10], big_keys[2500] };
+    assert(big.erase_keys(std::begin(few), std::end(few)) == 3);
+    assert(big.size() == 4997);
+    for (int i = 0; i < 5000; ++i) {
+        assert((i == 10 || i == 2500 || i == 4999) ? big.find(big_keys[i]) == big.end() : big[big_keys[i]] == i);
+    }
+}
+
+#if defined(SG14_BENCHMARKS)
+static void BulkBenchmark()
+{
+    // Spawn 100K values into an empty map, despawn them all in random
+    // order, then spawn them again through the free list.
+    const int n = 100000;
+    std::vector<int> src(n);
+    std::iota(src.begin(), src.end(), 0);
+    using SM = stdext::slot_map<int>;
+    std::vector<SM::key_type> keys(n);
+    SM one, bulk;
+    long long t[2][3];
+    for (int round = 0; round < 2; ++round) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < n; ++i) {
+            keys[i] = one.emplace(src[i]);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        bulk.emplace_range(src.begin(), src.end(), keys.begin());
+        auto t2 = std::chrono::high_resolution_clock::now();
+        t[0][round] = (long long)(t1 - t0).count();
+        t[1][round] = (long long)(t2 - t1).count();
+        if (round == 0) {
+            std::mt19937 g;
+            std::shuffle(keys.begin(), keys.end(), g);
+            auto t3 = std::chrono::high_resolution_clock::now();
+            for (auto&& k : keys) {
+                one.erase(k);
+            }
+            auto t4 = std::chrono::high_resolution_clock::now();
+            bulk.erase_keys(keys.begin(), keys.end());
+            auto t5 = std::chrono::high_resolution_clock::now();
+            assert(one.empty() && bulk.empty());
+            t[0][2] = (long long)(t4 - t3).count();
+            t[1][2] = (long long)(t5 - t4).count();
+        }
+    }
+    printf("slot_map<int> %d: emplace %lld / erase %lld / emplace again %lld;"
+        " emplace_range %lld / erase_keys %lld / emplace_range again %lld\n", n,
+        t[0][0], t[0][2], t[0][1], t[1][0], t[1][2], t[1][1]);
+}
 #endif
+
+template<class K>
+static bool keys_equal(const K& a, const K& b)
+{
+    using Traits = stdext::slot_map_key_traits<K>;
+    return Traits::get_index(a) == Traits::get_index(b) && Traits::get_generation(a) == Traits::get_generation(b);
 }
 
+template<class SM>
+static void SnapshotTest()
+{
+    using T = typename SM::mapped_type;
+    using K = typename SM::key_type;
+    SM sm;
+    std::vector<K> keys;
+    for (int i = 0; i < 300; ++i) {
+        keys.push_back(sm.emplace(Monad<T>::from_value(i)));
+    }
+    for (int i = 0; i < 300; i += 4) {
+        sm.erase(keys[i]);  // bump generations and build a free list
+    }
+    keys.push_back(sm.emplace(Monad<T>::from_value(1000)));
+
+    // Store the snapshot in 64-byte-aligned memory, like a mapped file.
+    std::vector<std::uint64_t> storage(sm.snapshot_size() / 8 + 16);
+    char *buffer = reinterpret_cast<char*>(storage.data());
+    buffer += (64 - reinterpret_cast<std::uintptr_t>(buffer) % 64) % 64;
+    size_t written = 0;
+    sm.write_snapshot([&](const void *p, size_t n) {
+        std::memcpy(buffer + written, p, n);
+        written += n;
+    });
+    assert(written == sm.snapshot_size());
+
+    SM loaded;
+    loaded.emplace(Monad<T>::from_value(7));
+    loaded.load_snapshot(buffer, written);
+    assert(loaded.size() == sm.size() && loaded.slot_count() == sm.slot_count());
+    assert(std::equal(sm.begin(), sm.end(), loaded.begin()));
+
+    stdext::slot_map_snapshot_view<T, K> view(buffer, written);
+    assert(view.size() == sm.size() && view.slot_count() == sm.slot_count());
+    assert(std::equal(sm.begin(), sm.end(), view.begin()));
+    for (auto&& k : keys) {
+        bool live = (sm.find(k) != sm.end());
+        assert((loaded.find(k) != loaded.end()) == live);
+        assert((view.find(k) != view.end()) == live);
+        if (live) {
+            assert(loaded[k] == sm[k] && view.at(k) == sm[k] && view[k] == sm[k]);
+        }
+    }
+
+    // The free list was restored exactly: both maps hand out the same keys.
+    for (int i = 0; i < 100; ++i) {
+        auto k1 = sm.emplace(Monad<T>::from_value(i));
+        auto k2 = loaded.emplace(Monad<T>::from_value(i));
+        assert(keys_equal(k1, k2));
+    }
+
+    // Truncated, mismatched or damaged snapshots are rejected.
+    auto rejects = [&](auto&& load) {
+        bool threw = false;
+        try { load(); } catch (const std::invalid_argument&) { threw = true; }
+        return threw;
+    };
+    assert(rejects([&]() { loaded.load_snapshot(buffer, written - 1); }));
+    assert(rejects([&]() { stdext::slot_map_snapshot_view<T, K>(buffer, 10); }));
+    assert(rejects([&]() { stdext::slot_map<char, K>().load_snapshot(buffer, written); }));
+    buffer[0] = 'X';
+    assert(rejects([&]() { loaded.load_snapshot(buffer, written); }));
+    assert(loaded.size() == sm.size());
+}
+
+static void SnapshotFileTest()
+{
+#if defined(__unix__)
+    // Write a snapshot to a file and read it back through mmap.
+    stdext::slot_map<double> sm;
+    auto k1 = sm.emplace(1.5);
+    auto k2 = sm.emplace(2.5);
+    sm.erase(k1);
+    FILE *f = tmpfile();
+    assert(f != nullptr);
+    sm.write_snapshot([f](const void *p, size_t n) { fwrite(p, 1, n, f); });
+    fflush(f);
+    size_t size = sm.snapshot_size();
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+    assert(data != MAP_FAILED);
+    {
+        stdext::slot_map_snapshot_view<double> view(data, size);
+        assert(view.size() == 1 && view.at(k2) == 2.5 && view.find(k1) == view.end());
+        stdext::slot_map<double> loaded;
+        loaded.load_snapshot(data, size);
+        assert(loaded.at(k2) == 2.5 && loaded.find(k1) == loaded.end());
+    }
+    munmap(data, size);
+    fclose(f);
+#endif
+}
+
+static void SnapshotValidationTest()
+{
+    // Damaged arrays are rejected by load_snapshot and never make the view
+    // read outside them.
+    using SM = stdext::slot_map<int>;
+    using K = SM::key_type;
+    SM sm;
+    std::vector<K> keys;
+    for (int i = 0; i < 8; ++i) {
+        keys.push_back(sm.emplace(i));
+    }
+    sm.erase(keys[2]);
+    sm.erase(keys[5]);
+    sm.erase(keys[6]);  // free list: 2 -> 5 -> 6
+    std::vector<std::uint64_t> storage(sm.snapshot_size() / 8 + 1);
+    char *buffer = reinterpret_cast<char*>(storage.data());
+    size_t written = 0;
+    sm.write_snapshot([&](const void *p, size_t n) { std::memcpy(buffer + written, p, n); written += n; });
+
+    stdext::slot_map_detail::snapshot_header h;
+    std::memcpy(&h, buffer, sizeof h);
+    K *slots = reinterpret_cast<K*>(buffer + h.slots_offset);
+    unsigned *reverse_map = reinterpret_cast<unsigned*>(buffer + h.reverse_map_offset);
+    const std::vector<std::uint64_t> pristine = storage;
+
+    auto rejects = [&](auto&& damage) {
+        storage = pristine;
+        damage();
+        SM loaded;
+        loaded.emplace(42);
+        bool threw = false;
+        try { loaded.load_snapshot(buffer, written); } catch (const std::invalid_argument&) { threw = true; }
+        assert(loaded.size() == (threw ? 1 : sm.size()));
+        stdext::slot_map_snapshot_view<int> view(buffer, written);
+        for (auto&& k : keys) {
+            auto it = view.find(k);
+            assert(it == view.end() || (view.begin() <= it && it < view.end()));
+        }
+        return threw;
+    };
+    assert(!rejects([]() {}));
+    assert(rejects([&]() { reverse_map[1] = (unsigned)h.slot_count; }));
+    assert(rejects([&]() { reverse_map[1] = reverse_map[0]; }));
+    assert(rejects([&]() { slots[keys[0].first].first = (unsigned)h.size + 3; }));
+    assert(rejects([&]() { slots[keys[5].first].first = keys[2].first; }));  // a cycle
+    assert(rejects([&]() { slots[keys[2].first].first = keys[3].first; }));  // through a live slot
+    assert(rejects([&]() { slots[keys[2].first].first = (unsigned)h.slot_count + 1; }));
+    assert(rejects([&]() {
+        h.last_available_slot_index = h.slot_count;
+        std::memcpy(buffer, &h, sizeof h);
+    }));
+}
+
+#if defined(SG14_BENCHMARKS)
+static void SnapshotBenchmark()
+{
+    // Restoring 1M values: re-inserting them (which gives new keys), copying
+    // a snapshot, or viewing it in place.
+    const int n = 1000000;
+    using SM = stdext::slot_map<int>;
+    SM sm;
+    for (int i = 0; i < n; ++i) {
+        sm.emplace(i);
+    }
+    std::vector<std::uint64_t> storage(sm.snapshot_size() / 8 + 1);
+    char *buffer = reinterpret_cast<char*>(storage.data());
+    size_t written = 0;
+    sm.write_snapshot([&](const void *p, size_t len) { std::memcpy(buffer + written, p, len); written += len; });
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    SM reinserted;
+    for (int v : sm) {
+        reinserted.emplace(v);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    SM loaded;
+    loaded.load_snapshot(buffer, written);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    stdext::slot_map_snapshot_view<int> view(buffer, written);
+    auto t3 = std::chrono::high_resolution_clock::now();
+    assert(reinserted.size() == sm.size() && loaded.size() == sm.size() && view.size() == sm.size());
+    printf("slot_map<int> restore %d: reinsert %lld, load_snapshot %lld, snapshot_view %lld\n", n,
+        (long long)(t1 - t0).count(), (long long)(t2 - t1).count(), (long long)(t3 - t2).count());
+}
+#endif
+
+template<class Key>
+static void GenerationPolicyTest()
+{
+    // Churn one slot well past its generation range, keeping every old key.
+    using Wrapping = stdext::slot_map<int, Key>;
+    using Retiring = stdext::slot_map<int, Key, std::vector, stdext::generation_policy::retire>;
+    Wrapping wsm;
+    Retiring rsm;
+    std::vector<Key> wkeys, rkeys;
+    bool wrapped_key_aliased = false;
+    for (int i = 0; i < 600; ++i) {
+        wkeys.push_back(wsm.emplace(i));
+        rkeys.push_back(rsm.emplace(i));
+        wsm.erase(wkeys.back());
+        rsm.erase(rkeys.back());
+        auto fresh_w = wsm.emplace(-1);
+        auto fresh_r = rsm.emplace(-1);
+        for (auto&& k : wkeys) {
+            wrapped_key_aliased |= (wsm.find(k) != wsm.end());
+        }
+        for (auto&& k : rkeys) {
+            assert(rsm.find(k) == rsm.end());  // no stale key ever comes back to life
+        }
+        assert(rsm.at(fresh_r) == -1);
+        wsm.erase(fresh_w);
+        rsm.erase(fresh_r);
+        wkeys.push_back(fresh_w);
+        rkeys.push_back(fresh_r);
+    }
+    assert(wrapped_key_aliased);
+    assert(wsm.slot_count() == 1);
+    assert(rsm.slot_count() > 1);  // retired slots were replaced by new ones
+    assert(rsm.empty());
+
+    // The retiring map still supports the bulk operations and snapshots.
+    std::vector<int> src(50, 7);
+    std::vector<Key> bulk_keys;
+    rsm.emplace_range(src.begin(), src.end(), std::back_inserter(bulk_keys));
+    assert(rsm.erase_keys(bulk_keys.begin(), bulk_keys.end()) == 50);
+    for (auto&& k : rkeys) {
+        assert(rsm.find(k) == rsm.end());
+    }
+}
+
+static void PackedKeyTest()
+{
+    using Key = stdext::packed_key<std::uint32_t, 20>;
+    static_assert(sizeof(Key) == sizeof(std::uint32_t), "");
+    static_assert(Key::generation_bits == 12, "");
+    Key k(5, 3);
+    assert(k.index() == 5 && k.generation() == 3);
+    assert(k.value() == ((3u << 20) | 5u));
+    assert(Key::from_value(k.value()) == k);
+    assert(std::hash<Key>()(k) == std::hash<std::uint32_t>()(k.value()));
+    assert(Key(5, 2) < k && k < Key(6, 3));  // the generation is the high-order field
+    k.set_index(0xFFFFF);
+    assert(k.index() == 0xFFFFF && k.generation() == 3);
+
+    // The generation wraps without disturbing the index.
+    Key last(9, 4095);
+    last.increment_generation();
+    assert(last.index() == 9 && last.generation() == 0);
+
+    using SM = stdext::slot_map<int, Key>;
+    SM sm;
+    auto k1 = sm.emplace(1);
+    sm.erase(k1);
+    for (int i = 0; i < 4095; ++i) {
+        sm.erase(sm.emplace(i));
+    }
+    auto k2 = sm.emplace(2);  // 4096 generations later, the key repeats
+    assert(k2 == k1 && sm.at(k1) == 2);
+    static_assert(sizeof(typename SM::key_type) == 4, "");
+}
+
+static void SlotExhaustionTest()
+{
+    // With an 8-bit index there are 255 usable slots; once they are all in
+    // use, or retired, emplace throws instead of handing out a bad key.
+    using SM = stdext::slot_map<int, std::pair<unsigned char, unsigned char>, std::vector, stdext::generation_policy::retire>;
+    SM sm;
+    for (int i = 0; i < 255; ++i) {
+        sm.emplace(i);
+    }
+    bool threw = false;
+    try { sm.emplace(255); } catch (const std::length_error&) { threw = true; }
+    assert(threw && sm.size() == 255);
+    sm.clear();
+
+    int cycles = 0;
+    threw = false;
+    try {
+        while (true) {
+            sm.erase(sm.emplace(cycles++));
+        }
+    } catch (const std::length_error&) {
+        threw = true;
+    }
+    assert(threw && sm.empty() && sm.slot_count() == 255);
+    assert(cycles == 255 * 255 + 1);  // each slot served 255 generations
+
+    sm.clear();  // clearing brings every slot back
+    auto k = sm.emplace(1);
+    assert(sm.at(k) == 1);
+}
+
+#if defined(SG14_BENCHMARKS)
+static void FindBatchBenchmark()
+{
+    // Both loops read every value found, resolving keys a frame's worth
+    // (1024) at a time, so that prefetched values are still in cache.
+    using SM = stdext::slot_map<int>;
+    for (int size : { 1000, 100000, 10000000 }) {
+        SM sm;
+        sm.reserve(size);
+        std::vector<SM::key_type> keys;
+        keys.reserve(size);
+        for (int i = 0; i < size; ++i) {
+            keys.push_back(sm.emplace(i));
+        }
+        std::mt19937 g;
+        std::vector<SM::key_type> probes(1000000);
+        for (auto&& k : probes) {
+            k = keys[g() % keys.size()];
+        }
+        const size_t frame = 1024;
+        std::vector<SM::iterator> results(frame);
+        long long scalar_sum = 0;
+        long long batch_sum = 0;
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (auto&& k : probes) {
+            auto it = sm.find(k);
+            if (it != sm.end()) {
+                scalar_sum += *it;
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < probes.size(); i += frame) {
+            size_t n = std::min(frame, probes.size() - i);
+            sm.find_batch(probes.begin() + i, probes.begin() + i + n, results.begin());
+            for (size_t j = 0; j < n; ++j) {
+                if (results[j] != sm.end()) {
+                    batch_sum += *results[j];
+                }
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        assert(scalar_sum == batch_sum);
+
+        printf("slot_map<int> %d: find %lld, find_batch %lld\n", size,
+            (long long)(t1 - t0).count(), (long long)(t2 - t1).count());
+    }
+}
+#endif
+
+#if defined(SG14_BENCHMARKS)
+static void StableInsertBenchmark()
+{
+    // The slowest single insert is where a vector-backed slot_map relocates
+    // all of its values; the chunked one allocates a chunk instead.
+    struct Big { char data[256]; };
+    auto worst_insert = [](auto& sm) {
+        long long worst = 0;
+        for (int i = 0; i < 200000; ++i) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            sm.emplace();
+            auto t1 = std::chrono::high_resolution_clock::now();
+            worst = std::max(worst, (long long)(t1 - t0).count());
+        }
+        return worst;
+    };
+    stdext::slot_map<Big> vector_sm;
+    stdext::stable_slot_map<Big> chunked_sm;
+    long long vector_worst = worst_insert(vector_sm);
+    long long chunked_worst = worst_insert(chunked_sm);
+    printf("slot_map<Big> worst insert of 200000: vector %lld, chunked_vector %lld\n",
+        vector_worst, chunked_worst);
+}
+#endif
+
 void sg14_test::slot_map_test()
 {
     TypedefTests();
@@ -525,6 +1336,12 @@ void sg14_test::slot_map_test()
     VerifyCapacityExists<slot_map_1>(true);
     GenerationsDontSkipTest<slot_map_1>();
     IndexesAreUsedEvenlyTest<slot_map_1>();
+    ReorderTest<slot_map_1>();
+    BulkInsertEraseTest<slot_map_1>();
+    SnapshotTest<slot_map_1>();
+    FindBatchTest<slot_map_1>();
+    FindBatchTest<slot_map_1>(40000);  // large enough to take the prefetching path
+    ParallelTest<slot_map_1>();
 
     // Test slot_map with a custom key type (C++14 destructuring).
     using slot_map_2 = stdext::slot_map<unsigned long, TestKey::key_16_8_t>;
@@ -538,6 +1355,10 @@ void sg14_test::slot_map_test()
     VerifyCapacityExists<slot_map_2>(true);
     GenerationsDontSkipTest<slot_map_2>();
     IndexesAreUsedEvenlyTest<slot_map_2>();
+    ReorderTest<slot_map_2>();
+    BulkInsertEraseTest<slot_map_2>();
+    SnapshotTest<slot_map_2>();
+    FindBatchTest<slot_map_2>();
 
 #if __cplusplus >= 201703L
     // Test slot_map with a custom key type (C++17 destructuring).
@@ -552,6 +1373,10 @@ void sg14_test::slot_map_test()
     VerifyCapacityExists<slot_map_3>(true);
     GenerationsDontSkipTest<slot_map_3>();
     IndexesAreUsedEvenlyTest<slot_map_3>();
+    ReorderTest<slot_map_3>();
+    BulkInsertEraseTest<slot_map_3>();
+    SnapshotTest<slot_map_3>();
+    FindBatchTest<slot_map_3>();
 #endif // __cplusplus >= 201703L
 
     // Test slot_map with a custom (but standard and random-access) container type.
@@ -566,6 +1391,12 @@ void sg14_test::slot_map_test()
     VerifyCapacityExists<slot_map_4>(false);
     GenerationsDontSkipTest<slot_map_4>();
     IndexesAreUsedEvenlyTest<slot_map_4>();
+    ReorderTest<slot_map_4>();
+    BulkInsertEraseTest<slot_map_4>();
+    SnapshotTest<slot_map_4>();
+    FindBatchTest<slot_map_4>();
+    FindBatchTest<slot_map_4>(40000);
+    ParallelTest<slot_map_4>();
 
     // Test slot_map with a custom (non-standard, random-access) container type.
     using slot_map_5 = stdext::slot_map<int, std::pair<unsigned, unsigned>, TestContainer::Vector>;
@@ -580,6 +1411,10 @@ void sg14_test::slot_map_test()
     VerifyCapacityExists<slot_map_5>(false);
     GenerationsDontSkipTest<slot_map_5>();
     IndexesAreUsedEvenlyTest<slot_map_5>();
+    ReorderTest<slot_map_5>();
+    BulkInsertEraseTest<slot_map_5>();
+    SnapshotTest<slot_map_5>();
+    FindBatchTest<slot_map_5>();
 
     // Test slot_map with a custom (standard, bidirectional-access) container type.
     using slot_map_6 = stdext::slot_map<int, std::pair<unsigned, unsigned>, std::list>;
@@ -595,6 +1430,11 @@ void sg14_test::slot_map_test()
     VerifyCapacityExists<slot_map_6>(false);
     GenerationsDontSkipTest<slot_map_6>();
     IndexesAreUsedEvenlyTest<slot_map_6>();
+    ReorderTest<slot_map_6>();
+    BulkInsertEraseTest<slot_map_6>();
+    SnapshotTest<slot_map_6>();
+    FindBatchTest<slot_map_6>();
+    ParallelTest<slot_map_6>(1000);  // std::list has no random access, so keep it small
 
     // Test slot_map with a move-only value_type.
     // Sadly, standard containers do not propagate move-only-ness, so we must use our custom Vector instead.
@@ -613,6 +1453,68 @@ void sg14_test::slot_map_test()
     VerifyCapacityExists<slot_map_7>(false);
     GenerationsDontSkipTest<slot_map_7>();
     IndexesAreUsedEvenlyTest<slot_map_7>();
+    ReorderTest<slot_map_7>();
+    BulkInsertEraseTest<slot_map_7>();
+    FindBatchTest<slot_map_7>();
+
+    // Test slot_map with chunked, address-stable storage.
+    using slot_map_8 = stdext::stable_slot_map<int>;
+    static_assert(std::is_same<slot_map_8::container_type, stdext::chunked_vector<int>>::value, "");
+    static_assert(std::is_nothrow_move_constructible<slot_map_8>::value, "preserve nothrow-movability of chunked_vector");
+    BasicTests<slot_map_8>(415, 315);
+    BoundsCheckingTest<slot_map_8>();
+    FullContainerStressTest<slot_map_8>([]() { return 37; });
+    InsertEraseStressTest<slot_map_8>([i=7]() mutable { return ++i; });
+    EraseInLoopTest<slot_map_8>();
+    EraseRangeTest<slot_map_8>();
+    ReserveTest<slot_map_8>();
+    VerifyCapacityExists<slot_map_8>(true);
+    GenerationsDontSkipTest<slot_map_8>();
+    IndexesAreUsedEvenlyTest<slot_map_8>();
+    ReorderTest<slot_map_8>();
+    BulkInsertEraseTest<slot_map_8>();
+    SnapshotTest<slot_map_8>();
+    FindBatchTest<slot_map_8>();
+    FindBatchTest<slot_map_8>(40000);
+    StableAddressTest<slot_map_8>();
+    ParallelTest<slot_map_8>();
+
+    // Test slot_map with a key packed into a single 32-bit word.
+    using slot_map_9 = stdext::slot_map<int, stdext::packed_key<std::uint32_t, 20>>;
+    BasicTests<slot_map_9>(42, 37);
+    BoundsCheckingTest<slot_map_9>();
+    FullContainerStressTest<slot_map_9>([]() { return 1; });
+    InsertEraseStressTest<slot_map_9>([i=3]() mutable { return ++i; });
+    EraseInLoopTest<slot_map_9>();
+    EraseRangeTest<slot_map_9>();
+    ReserveTest<slot_map_9>();
+    VerifyCapacityExists<slot_map_9>(true);
+    GenerationsDontSkipTest<slot_map_9>();
+    IndexesAreUsedEvenlyTest<slot_map_9>();
+    ReorderTest<slot_map_9>();
+    BulkInsertEraseTest<slot_map_9>();
+    SnapshotTest<slot_map_9>();
+    FindBatchTest<slot_map_9>();
+
+    ChunkedVectorTest();
+    ParallelRunsTest();
+    SortValuesTest();
+    BulkInsertTest();
+    SnapshotFileTest();
+    SnapshotValidationTest();
+    GenerationPolicyTest<TestKey::key_16_8_t>();
+    GenerationPolicyTest<stdext::packed_key<std::uint16_t, 8>>();
+#if __cplusplus >= 201703L
+    GenerationPolicyTest<TestKey::key_11_5_t>();
+#endif
+    SlotExhaustionTest();
+    PackedKeyTest();
+#if defined(SG14_BENCHMARKS)
+    FindBatchBenchmark();
+    StableInsertBenchmark();
+    BulkBenchmark();
+    SnapshotBenchmark();
+#endif
 }
 
 #if defined(__cpp_concepts)
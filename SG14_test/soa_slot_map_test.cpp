@@ -0,0 +1,241 @@
+#include "SG14_test.h"
+#include "soa_slot_map.h"
+#include "slot_map.h"
+#include <assert.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+struct Vec3 {
+    float x, y, z;
+};
+
+// Throws from its constructor when asked to.
+struct Fragile {
+    explicit Fragile(bool fail) : value(1) { if (fail) throw std::runtime_error("Fragile"); }
+    int value;
+};
+
+} // namespace
+
+static void BasicTest()
+{
+    using SM = stdext::soa_slot_map<int, std::string, double>;
+    static_assert(SM::column_count == 3, "");
+    static_assert(std::is_same<SM::column_type<1>, std::string>::value, "");
+    SM sm;
+    assert(sm.empty());
+    auto k1 = sm.emplace(1, "one", 1.5);
+    auto k2 = sm.insert(std::make_tuple(2, std::string("two"), 2.5));
+    auto k3 = sm.emplace();
+    assert(sm.size() == 3);
+    assert(sm.slot_count() >= 3);
+
+    assert(std::get<1>(sm[k1]) == "one");
+    assert(sm.at<0>(k2) == 2);
+    assert(sm.at<1>(k3).empty() && sm.at<2>(k3) == 0.0);
+    std::get<2>(sm.at(k3)) = 3.5;
+    assert(sm.at<2>(k3) == 3.5);
+
+    auto it = sm.find(k2);
+    assert(it != sm.end());
+    assert(*it == std::make_tuple(2, std::string("two"), 2.5));
+    assert(sm.find_unchecked(k2) == it);
+
+    const SM& csm = sm;
+    SM::const_iterator cit = csm.find(k1);
+    assert(std::get<1>(*cit) == "one");
+    static_assert(std::is_same<decltype(*cit), std::tuple<const int&, const std::string&, const double&>>::value, "");
+
+    assert(sm.erase(k1) == 1);
+    assert(sm.erase(k1) == 0);
+    assert(sm.find(k1) == sm.end());
+    bool threw = false;
+    try { sm.at<1>(k1); } catch (const std::out_of_range&) { threw = true; }
+    assert(threw);
+
+    // Erasing moved the last value of every column into the hole.
+    assert(sm.size() == 2);
+    assert(sm.column<0>().size() == 2 && sm.column<1>().size() == 2 && sm.column<2>().size() == 2);
+    assert(sm.at<0>(k3) == 0 && sm.at<2>(k3) == 3.5);
+    assert(sm.at<1>(k2) == "two" && sm.at<2>(k2) == 2.5);
+
+    sm.erase(sm.find(k3));
+    assert(sm.size() == 1);
+    sm.clear();
+    assert(sm.empty() && sm.slot_count() == 0);
+}
+
+static void ColumnTest()
+{
+    using SM = stdext::soa_slot_map<Vec3, Vec3, int>;
+    SM sm;
+    sm.reserve(100);
+    assert(sm.capacity() >= 100 && sm.slot_count() >= 100);
+    std::vector<SM::key_type> keys;
+    for (int i = 0; i < 100; ++i) {
+        float f = static_cast<float>(i);
+        keys.push_back(sm.emplace(Vec3{f, f, f}, Vec3{1, 2, 3}, i));
+    }
+    for (int i = 0; i < 100; i += 4) {
+        sm.erase(keys[i]);
+    }
+
+    // Columns are contiguous and in matching order.
+    auto positions = sm.column<0>();
+    auto velocities = sm.column<1>();
+    auto ids = sm.column<2>();
+    assert(positions.size() == 75 && ids.data() + 75 == ids.end());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        assert(positions[i].x == static_cast<float>(ids[i]));
+        positions[i].x += velocities[i].x;
+    }
+    for (int i = 0; i < 100; ++i) {
+        if (i % 4 != 0) {
+            assert(sm.at<0>(keys[i]).x == static_cast<float>(i) + 1);
+        }
+    }
+
+    // zip<I...>() visits only the named columns.
+    auto zv = sm.zip<0, 2>();
+    static_assert(std::is_same<decltype(*zv.begin()), std::tuple<Vec3&, int&>>::value, "");
+    assert(zv.size() == sm.size());
+    int count = 0;
+    for (auto&& row : zv) {
+        std::get<0>(row).y = static_cast<float>(std::get<1>(row));
+        ++count;
+    }
+    assert(count == 75);
+    const SM& csm = sm;
+    for (auto&& row : csm.zip<2, 0>()) {
+        assert(std::get<1>(row).y == static_cast<float>(std::get<0>(row)));
+    }
+    assert(csm.column<2>().size() == 75);
+
+#if __cplusplus >= 201703L
+    for (auto [pos, vel, id] : sm) {
+        pos.z = vel.z * static_cast<float>(id);
+    }
+    for (int i = 1; i < 100; i += 4) {
+        assert(sm.at<0>(keys[i]).z == 3.0f * static_cast<float>(i));
+    }
+#endif
+}
+
+template<class Key>
+static void StressTest()
+{
+    // Mirror every operation in a plain slot_map.
+    using SM = stdext::basic_soa_slot_map<Key, int, std::unique_ptr<int>>;
+    using Mirror = stdext::slot_map<int>;
+    SM sm;
+    Mirror mirror;
+    std::vector<std::pair<typename SM::key_type, Mirror::key_type>> live;
+    std::mt19937 g;
+    for (int i = 0; i < 20000; ++i) {
+        if (live.empty() || g() % 3 != 0) {
+            int v = static_cast<int>(g() % 1000);
+            live.emplace_back(sm.emplace(v, std::make_unique<int>(-v)), mirror.emplace(v));
+        } else {
+            size_t victim = g() % live.size();
+            assert(sm.erase(live[victim].first) == 1);
+            mirror.erase(live[victim].second);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+    assert(sm.size() == mirror.size() && sm.size() == live.size());
+    for (auto&& kk : live) {
+        int v = mirror[kk.second];
+        assert(sm.template at<0>(kk.first) == v);
+        assert(*sm.template at<1>(kk.first) == -v);
+    }
+    for (auto&& row : sm) {
+        assert(*std::get<1>(row) == -std::get<0>(row));
+    }
+}
+
+static void ExceptionSafetyTest()
+{
+    // A column whose constructor throws leaves the earlier columns as they were.
+    using SM = stdext::soa_slot_map<std::string, Fragile, int>;
+    SM sm;
+    auto k1 = sm.emplace("one", false, 1);
+    bool threw = false;
+    try { sm.emplace("two", true, 2); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw && sm.size() == 1);
+    assert(sm.column<0>().size() == 1 && sm.column<2>().size() == 1);
+    auto k2 = sm.emplace("three", false, 3);
+    assert(sm.at<0>(k1) == "one" && sm.at<0>(k2) == "three" && sm.at<2>(k2) == 3);
+
+    // With an 8-bit index there are 255 usable slots.
+    using Small = stdext::basic_soa_slot_map<std::pair<unsigned char, unsigned char>, int, std::string>;
+    Small small;
+    for (int i = 0; i < 255; ++i) {
+        small.emplace(i, "x");
+    }
+    threw = false;
+    try { small.emplace(255, "x"); } catch (const std::length_error&) { threw = true; }
+    assert(threw && small.size() == 255 && small.column<1>().size() == 255);
+    threw = false;
+    try { Small().reserve_slots(257); } catch (const std::length_error&) { threw = true; }
+    assert(threw);
+    Small().reserve_slots(255);
+}
+
+#if defined(SG14_BENCHMARKS)
+static void ColumnBenchmark()
+{
+    // Updating one field touches a single column of the soa_slot_map, but
+    // every byte of the array-of-structs slot_map.
+    struct Entity { Vec3 position; Vec3 velocity; float health; char name[52]; };
+    const int n = 1000000;
+    stdext::slot_map<Entity> aos;
+    stdext::soa_slot_map<Vec3, Vec3, float, std::string> soa;
+    aos.reserve(n);
+    soa.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        aos.emplace(Entity{{0, 0, 0}, {1, 1, 1}, 100, "entity"});
+        soa.emplace(Vec3{0, 0, 0}, Vec3{1, 1, 1}, 100.0f, "entity");
+    }
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (auto&& e : aos) {
+        e.health -= 1;
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (float& h : soa.column<2>()) {
+        h -= 1;
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    assert(aos.begin()->health == 99 && soa.column<2>()[0] == 99);
+    printf("update one field of %d: slot_map %lld, soa_slot_map %lld\n", n,
+        (long long)(t1 - t0).count(), (long long)(t2 - t1).count());
+}
+#endif
+
+void sg14_test::soa_slot_map_test()
+{
+    BasicTest();
+    ColumnTest();
+    StressTest<std::pair<unsigned, unsigned>>();
+    StressTest<stdext::packed_key<std::uint32_t, 20>>();
+    ExceptionSafetyTest();
+#if defined(SG14_BENCHMARKS)
+    ColumnBenchmark();
+#endif
+}
+
+#ifdef TEST_MAIN
+int main()
+{
+    sg14_test::soa_slot_map_test();
+}
+#endif